@@ -9,18 +9,23 @@
 
 using namespace std;
 
-void bidirectional_stream_copy( Socket& socket, string_view peer_name )
+void bidirectional_stream_copy( Socket& socket, string_view peer_name, bool report_stats )
 {
   constexpr size_t buffer_size = 1048576;
 
   EventLoop _eventloop {};
   FileDescriptor _input { STDIN_FILENO };
   FileDescriptor _output { STDOUT_FILENO };
-  ByteStream _outbound { buffer_size };
-  ByteStream _inbound { buffer_size };
+  ByteStream _outbound { buffer_size, ByteStream::Storage::Mirrored };
+  ByteStream _inbound { buffer_size, ByteStream::Storage::Mirrored };
   bool _outbound_shutdown { false };
   bool _inbound_shutdown { false };
 
+  if ( report_stats ) {
+    _outbound.enable_stats();
+    _inbound.enable_stats();
+  }
+
   socket.set_blocking( false );
   _input.set_blocking( false );
   _output.set_blocking( false );
@@ -31,10 +36,8 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     _input,
     Direction::In,
     [&] {
-      string data;
-      data.resize( _outbound.writer().available_capacity() );
-      _input.read( data );
-      _outbound.writer().push( move( data ) );
+      Writer& outbound = _outbound.writer();
+      outbound.commit( _input.read( outbound.reserve( outbound.available_capacity() ) ) );
       if ( _input.eof() ) {
         _outbound.writer().close();
       }
@@ -57,7 +60,7 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     Direction::Out,
     [&] {
       if ( _outbound.reader().bytes_buffered() ) {
-        _outbound.reader().pop( socket.write( _outbound.reader().peek() ) );
+        _outbound.reader().pop( socket.write( _outbound.reader().peek_all() ) );
       }
       if ( _outbound.reader().is_finished() ) {
         socket.shutdown( SHUT_WR );
@@ -81,10 +84,8 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     socket,
     Direction::In,
     [&] {
-      string data;
-      data.resize( _inbound.writer().available_capacity() );
-      socket.read( data );
-      _inbound.writer().push( move( data ) );
+      Writer& inbound = _inbound.writer();
+      inbound.commit( socket.read( inbound.reserve( inbound.available_capacity() ) ) );
       if ( socket.eof() ) {
         _inbound.writer().close();
       }
@@ -107,7 +108,7 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
     Direction::Out,
     [&] {
       if ( _inbound.reader().bytes_buffered() ) {
-        _inbound.reader().pop( _output.write( _inbound.reader().peek() ) );
+        _inbound.reader().pop( _output.write( _inbound.reader().peek_all() ) );
       }
       if ( _inbound.reader().is_finished() ) {
         _output.close();
@@ -129,6 +130,10 @@ void bidirectional_stream_copy( Socket& socket, string_view peer_name )
   // loop until completion
   while ( true ) {
     if ( EventLoop::Result::Exit == _eventloop.wait_next_event( -1 ) ) {
+      if ( report_stats ) {
+        cerr << "DEBUG: Outbound stream stats: " << _outbound.stats() << "\n";
+        cerr << "DEBUG: Inbound stream stats: " << _inbound.stats() << "\n";
+      }
       return;
     }
   }
@@ -2,5 +2,5 @@
 
 #include "socket.hh"
 
-//! Copy socket input/output to stdin/stdout until finished
-void bidirectional_stream_copy( Socket& socket, std::string_view peer_name );
+//! Copy socket input/output to stdin/stdout until finished (optionally reporting ByteStream::Stats at the end)
+void bidirectional_stream_copy( Socket& socket, std::string_view peer_name, bool report_stats = false );
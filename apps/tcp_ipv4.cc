@@ -33,6 +33,9 @@ void show_usage( const char* argv0, const char* msg )
        << "   -w <winsz>      Use a window of <winsz> bytes                   " << TCPConfig::MAX_PAYLOAD_SIZE
        << "\n\n"
 
+       << "   -m <mss>        Set the maximum segment size to <mss> bytes     " << TCPConfig::MAX_PAYLOAD_SIZE
+       << "\n\n"
+
        << "   -t <tmout>      Set rt_timeout to tmout                         " << TCPConfig::TIMEOUT_DFLT << "\n\n"
 
        << "   -d <tundev>     Connect to tun <tundev>                         " << TUN_DFLT << "\n\n"
@@ -40,6 +43,8 @@ void show_usage( const char* argv0, const char* msg )
        << "   -Lu <loss>      Set uplink loss to <rate> (float in 0..1)       (no loss)\n"
        << "   -Ld <loss>      Set downlink loss to <rate> (float in 0..1)     (no loss)\n\n"
 
+       << "   -S              Report ByteStream stats when streams finish.    (off)\n\n"
+
        << "   -h              Show this message.\n\n";
 
   if ( msg != nullptr ) {
@@ -76,6 +81,10 @@ tuple<TCPConfig, FdAdapterConfig, bool, const char*> get_config( const span<char
       listen = true;
       curr += 1;
 
+    } else if ( strncmp( "-S", args[curr], 3 ) == 0 ) {
+      c_fsm.stream_stats = true;
+      curr += 1;
+
     } else if ( strncmp( "-a", args[curr], 3 ) == 0 ) {
       check_argc( args, curr, "ERROR: -a requires one argument." );
       source_address = args[curr + 1];
@@ -91,6 +100,11 @@ tuple<TCPConfig, FdAdapterConfig, bool, const char*> get_config( const span<char
       c_fsm.recv_capacity = strtol( args[curr + 1], nullptr, 0 );
       curr += 2;
 
+    } else if ( strncmp( "-m", args[curr], 3 ) == 0 ) {
+      check_argc( args, curr, "ERROR: -m requires one argument." );
+      c_fsm.mss = static_cast<uint16_t>( strtol( args[curr + 1], nullptr, 0 ) );
+      curr += 2;
+
     } else if ( strncmp( "-t", args[curr], 3 ) == 0 ) {
       check_argc( args, curr, "ERROR: -t requires one argument." );
       c_fsm.rt_timeout = strtol( args[curr + 1], nullptr, 0 );
@@ -167,7 +181,7 @@ int main( int argc, char** argv )
       tcp_socket.connect( c_fsm, c_filt );
     }
 
-    bidirectional_stream_copy( tcp_socket, tcp_socket.peer_address().to_string() );
+    bidirectional_stream_copy( tcp_socket, tcp_socket.peer_address().to_string(), c_fsm.stream_stats );
     tcp_socket.wait_until_closed();
   } catch ( const exception& e ) {
     cerr << "Exception: " << e.what() << endl;
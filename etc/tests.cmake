@@ -23,6 +23,8 @@ ttest(byte_stream_one_write)
 ttest(byte_stream_two_writes)
 ttest(byte_stream_many_writes)
 ttest(byte_stream_stress_test)
+ttest(byte_stream_spsc)
+ttest(byte_stream_stats)
 
 ttest(reassembler_single)
 ttest(reassembler_cap)
@@ -31,6 +33,8 @@ ttest(reassembler_dup)
 ttest(reassembler_holes)
 ttest(reassembler_overlapping)
 ttest(reassembler_win)
+ttest(reassembler_interval_set)
+ttest(reassembler_limits)
 
 ttest(wrapping_integers_cmp)
 ttest(wrapping_integers_wrap)
@@ -53,6 +57,10 @@ ttest(send_window)
 ttest(send_ack)
 ttest(send_close)
 ttest(send_extra)
+ttest(send_recovery)
+ttest(peer_delayed_ack)
+ttest(peer_congestion_control)
+ttest(peer_mss)
 
 ttest(net_interface)
 
@@ -90,3 +98,8 @@ set_tests_properties(${compile_name_opt} PROPERTIES FIXTURES_SETUP compile_opt)
 
 stest(byte_stream_speed_test)
 stest(reassembler_speed_test)
+stest(fd_splice_speed_test)
+stest(byte_stream_sweep_speed_test)
+stest(reassembler_workloads_speed_test)
+stest(wrapping_integers_speed_test)
+stest(tcp_sender_speed_test)
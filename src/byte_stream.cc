@@ -1,10 +1,46 @@
 #include "byte_stream.hh"
+#include "exception.hh"
+#include <algorithm>
+#include <chrono>
 #include <string>
 #include <string_view>
 
 using namespace std;
 
-ByteStream::ByteStream( uint64_t capacity ) : capacity_( capacity ) {}
+namespace {
+
+AnyStorage make_storage( uint64_t capacity, ByteStream::Storage storage )
+{
+  switch ( storage ) {
+    case ByteStream::Storage::Ring:
+      return RingStorage { capacity };
+    case ByteStream::Storage::Chunked:
+      return ChunkedStorage { capacity };
+    case ByteStream::Storage::Mirrored:
+      try {
+        return MirroredStorage { capacity };
+      } catch ( const unix_error& ) {
+        // e.g. memfd_create unavailable: keep the O(1) ring, at the cost of split peeks
+        return RingStorage { capacity };
+      }
+    case ByteStream::Storage::Slab:
+      return SlabStorage { capacity };
+    case ByteStream::Storage::Contiguous:
+      break;
+  }
+  return ContiguousStorage { capacity };
+}
+
+int64_t now_ns()
+{
+  return chrono::duration_cast<chrono::nanoseconds>( chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+} // namespace
+
+ByteStream::ByteStream( uint64_t capacity, Storage storage )
+  : capacity_( capacity ), buffer_( make_storage( capacity, storage ) )
+{}
 
 bool Writer::is_closed() const
 {
@@ -15,17 +51,43 @@ bool Writer::is_closed() const
 void Writer::push( string data )
 {
   // Your code here.
+  reserved_ = 0;
   if ( closed_ )
     return;
-  auto avalcap = available_capacity();
-  if ( data.size() > avalcap ) {
-    buffer_ += std::move( data ).substr( 0, avalcap );
-    pushed_ += avalcap;
-  } else {
-    buffer_ += std::move( data );
-    pushed_ += data.size();
+  const auto len = min( static_cast<uint64_t>( data.size() ), available_capacity() );
+  if ( stats_enabled_ and len < data.size() )
+    note_stall_();
+  if ( len == 0 )
+    return;
+  data.resize( len );
+  pushed_ += len;
+  const auto copied = visit( [&]( auto& storage ) { return storage.push( std::move( data ) ); }, buffer_ );
+  if ( stats_enabled_ ) {
+    stats_.bytes_copied += copied;
+    note_buffered_();
   }
-  return;
+}
+
+vector<span<char>> Writer::reserve( uint64_t len )
+{
+  vector<span<char>> regions;
+  reserved_ = closed_ ? 0 : min( len, available_capacity() );
+  if ( stats_enabled_ and len and not closed_ and reserved_ == 0 )
+    note_stall_();
+  if ( reserved_ ) {
+    visit( [&]( auto& storage ) { storage.reserve( reserved_, regions ); }, buffer_ );
+  }
+  return regions;
+}
+
+void Writer::commit( uint64_t len )
+{
+  len = min( len, reserved_ );
+  reserved_ = 0;
+  pushed_ += len;
+  visit( [&]( auto& storage ) { storage.commit( len ); }, buffer_ );
+  if ( stats_enabled_ )
+    note_buffered_();
 }
 
 void Writer::close()
@@ -37,7 +99,7 @@ void Writer::close()
 uint64_t Writer::available_capacity() const
 {
   // Your code here.
-  return capacity_ - buffer_.size();
+  return capacity_ - buffered_size_();
 }
 
 uint64_t Writer::bytes_pushed() const
@@ -49,7 +111,7 @@ uint64_t Writer::bytes_pushed() const
 bool Reader::is_finished() const
 {
   // Your code here.
-  return closed_ && buffer_.size() == 0;
+  return closed_ && buffered_size_() == 0;
 }
 
 uint64_t Reader::bytes_popped() const
@@ -61,22 +123,71 @@ uint64_t Reader::bytes_popped() const
 string_view Reader::peek() const
 {
   // Your code here.
-  return string_view( buffer_ );
+  const auto view = visit( []( const auto& storage ) { return storage.peek(); }, buffer_ );
+  if ( stats_enabled_ )
+    note_peek_( view.empty() );
+  return view;
+}
+
+vector<string_view> Reader::peek_all() const
+{
+  vector<string_view> views;
+  visit( [&]( const auto& storage ) { storage.peek_all( views ); }, buffer_ );
+  if ( stats_enabled_ )
+    note_peek_( views.empty() );
+  return views;
 }
 
 void Reader::pop( uint64_t len )
 {
   // Your code here.
-  if ( len >= buffer_.size() ) {
-    buffer_ = "";
-  } else {
-    buffer_ = std::move( buffer_ ).substr( len, buffer_.size() - len );
-  }
+  const auto n = min( len, buffered_size_() );
+  visit( [&]( auto& storage ) { storage.pop( n ); }, buffer_ );
   poped_ += len;
+  if ( stats_enabled_ ) {
+    ++stats_.pops;
+    if ( n and stall_started_ns_ ) {
+      stats_.writer_full_ns += now_ns() - stall_started_ns_;
+      stall_started_ns_ = 0;
+    }
+  }
 }
 
 uint64_t Reader::bytes_buffered() const
 {
   // Your code here.
-  return buffer_.size();
+  return buffered_size_();
+}
+
+uint64_t ByteStream::buffered_size_() const
+{
+  return visit( []( const auto& storage ) { return storage.size(); }, buffer_ );
+}
+
+ByteStream::Stats ByteStream::stats() const
+{
+  auto snapshot = stats_;
+  if ( stall_started_ns_ ) {
+    snapshot.writer_full_ns += now_ns() - stall_started_ns_;
+  }
+  return snapshot;
+}
+
+void ByteStream::note_stall_()
+{
+  ++stats_.writer_full_stalls;
+  if ( not stall_started_ns_ ) {
+    stall_started_ns_ = now_ns();
+  }
+}
+
+void ByteStream::note_buffered_()
+{
+  stats_.high_water_mark = max( stats_.high_water_mark, buffered_size_() );
+}
+
+void ByteStream::note_peek_( bool empty ) const
+{
+  ++stats_.peeks;
+  stats_.reader_empty_polls += empty;
 }
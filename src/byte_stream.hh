@@ -1,9 +1,14 @@
 #pragma once
 
+#include "byte_stream_storage.hh"
+
 #include <cstdint>
+#include <iosfwd>
+#include <span>
 #include <string>
 #include <string_view>
 #include <sys/types.h>
+#include <vector>
 
 class Reader;
 class Writer;
@@ -11,7 +16,17 @@ class Writer;
 class ByteStream
 {
 public:
-  explicit ByteStream( uint64_t capacity );
+  // How the buffered bytes are stored (see byte_stream_storage.hh)
+  enum class Storage
+  {
+    Contiguous, // one string; peek() sees every buffered byte, pop() moves the rest
+    Ring,       // fixed-capacity circular buffer; O(1) pop, peek() stops at the wrap point
+    Chunked,    // list of the pushed strings, adopted without copying; peek() returns the front chunk
+    Mirrored,   // ring mapped twice in virtual memory; O(1) pop, peek() sees every buffered byte
+    Slab,       // 16 KB slabs from a per-thread pool, held only while they buffer bytes; peek() stops at a slab
+  };
+
+  explicit ByteStream( uint64_t capacity, Storage storage = Storage::Contiguous );
 
   // Helper functions (provided) to access the ByteStream's Reader and Writer interfaces
   Reader& reader();
@@ -22,14 +37,39 @@ public:
   void set_error() { error_ = true; };       // Signal that the stream suffered an error.
   bool has_error() const { return error_; }; // Has the stream had an error?
 
+  // Occupancy and stall counters, collected only once enable_stats() has been called
+  struct Stats
+  {
+    uint64_t high_water_mark {};    // most bytes ever buffered at once
+    uint64_t writer_full_stalls {}; // pushes that were cut short, or reserves that found no space
+    uint64_t writer_full_ns {};     // time from such a stall until the reader next popped bytes
+    uint64_t reader_empty_polls {}; // peeks that found nothing buffered
+    uint64_t bytes_copied {};       // bytes the storage copied on push (adopted strings cost nothing)
+    uint64_t peeks {};              // calls to peek() or peek_all()
+    uint64_t pops {};               // calls to pop()
+  };
+
+  void enable_stats() { stats_enabled_ = true; }
+  bool stats_enabled() const { return stats_enabled_; }
+  Stats stats() const; // snapshot (an ongoing stall counts up to now)
+
 protected:
   // Please add any additional state to the ByteStream here, and not to the Writer and Reader interfaces.
   uint64_t capacity_;
   uint64_t poped_ {};
   uint64_t pushed_ {};
-  std::string buffer_ {};
+  AnyStorage buffer_;
   bool error_ {};
   bool closed_ {};
+  uint64_t reserved_ {}; // bytes handed out by Writer::reserve() and not yet committed
+  bool stats_enabled_ {};
+  mutable Stats stats_ {};      // mutable: peeks are counted too
+  int64_t stall_started_ns_ {}; // steady_clock time of an unresolved writer-full stall, or 0
+
+  uint64_t buffered_size_() const;
+  void note_stall_();
+  void note_buffered_();
+  void note_peek_( bool empty ) const;
 };
 
 class Writer : public ByteStream
@@ -38,6 +78,11 @@ public:
   void push( std::string data ); // Push data to stream, but only as much as available capacity allows.
   void close();                  // Signal that the stream has reached its ending. Nothing more will be written.
 
+  // Writable regions for up to `len` bytes (capped at available capacity) inside the stream's own storage.
+  // Fill them in order, then commit() how many bytes were written; don't push() in between.
+  std::vector<std::span<char>> reserve( uint64_t len );
+  void commit( uint64_t len ); // Publish the first `len` reserved bytes, releasing the rest of the reservation
+
   bool is_closed() const;              // Has the stream been closed?
   uint64_t available_capacity() const; // How many bytes can be pushed to the stream right now?
   uint64_t bytes_pushed() const;       // Total number of bytes cumulatively pushed to the stream
@@ -49,6 +94,9 @@ public:
   std::string_view peek() const; // Peek at the next bytes in the buffer
   void pop( uint64_t len );      // Remove `len` bytes from the buffer
 
+  // Views of every buffered byte, in order (e.g. for one writev); pop() what was consumed.
+  std::vector<std::string_view> peek_all() const;
+
   bool is_finished() const;        // Is the stream finished (closed and fully popped)?
   uint64_t bytes_buffered() const; // Number of bytes currently buffered (pushed and not popped)
   uint64_t bytes_popped() const;   // Total number of bytes cumulatively popped from stream
@@ -59,3 +107,9 @@ public:
  * from a ByteStream Reader into a string;
  */
 void read( Reader& reader, uint64_t len, std::string& out );
+
+// Print ByteStream::Stats as "key=value" pairs on one line
+std::ostream& operator<<( std::ostream& out, const ByteStream::Stats& stats );
+
+// Lower-case name of a storage kind (e.g. "ring"), for benchmark output
+std::string storage_name( ByteStream::Storage storage );
@@ -1,6 +1,7 @@
 #include "byte_stream.hh"
 
 #include <cstdint>
+#include <ostream>
 #include <stdexcept>
 
 /*
@@ -24,6 +25,31 @@ void read( Reader& reader, uint64_t len, std::string& out )
   }
 }
 
+std::ostream& operator<<( std::ostream& out, const ByteStream::Stats& stats )
+{
+  return out << "high_water_mark=" << stats.high_water_mark << " writer_full_stalls=" << stats.writer_full_stalls
+             << " writer_full_ms=" << stats.writer_full_ns / 1000000
+             << " reader_empty_polls=" << stats.reader_empty_polls << " bytes_copied=" << stats.bytes_copied
+             << " peeks=" << stats.peeks << " pops=" << stats.pops;
+}
+
+std::string storage_name( ByteStream::Storage storage )
+{
+  switch ( storage ) {
+    case ByteStream::Storage::Contiguous:
+      return "contiguous";
+    case ByteStream::Storage::Ring:
+      return "ring";
+    case ByteStream::Storage::Chunked:
+      return "chunked";
+    case ByteStream::Storage::Mirrored:
+      return "mirrored";
+    case ByteStream::Storage::Slab:
+      return "slab";
+  }
+  return "unknown";
+}
+
 Reader& ByteStream::reader()
 {
   static_assert( sizeof( Reader ) == sizeof( ByteStream ),
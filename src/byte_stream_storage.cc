@@ -0,0 +1,411 @@
+#include "byte_stream_storage.hh"
+
+#include "exception.hh"
+
+#include <algorithm>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <utility>
+
+using namespace std;
+
+uint64_t ContiguousStorage::push( string data )
+{
+  commit( 0 );
+  if ( buffer_.empty() ) {
+    buffer_ = std::move( data );
+    return 0;
+  }
+  buffer_ += data;
+  return data.size();
+}
+
+void ContiguousStorage::peek_all( vector<string_view>& out ) const
+{
+  if ( size() ) {
+    out.push_back( peek() );
+  }
+}
+
+void ContiguousStorage::pop( uint64_t len )
+{
+  buffer_.erase( 0, len );
+}
+
+void ContiguousStorage::reserve( uint64_t len, vector<span<char>>& out )
+{
+  commit( 0 );
+  buffer_.resize( buffer_.size() + len );
+  reserved_ = len;
+  out.emplace_back( buffer_.data() + buffer_.size() - len, len );
+}
+
+void ContiguousStorage::commit( uint64_t len )
+{
+  buffer_.resize( buffer_.size() - reserved_ + len );
+  reserved_ = 0;
+}
+
+uint64_t RingStorage::push( string data )
+{
+  const auto tail = ( head_ + size_ ) % buffer_.size();
+  const auto first = min( data.size(), buffer_.size() - tail );
+  copy_n( data.data(), first, buffer_.data() + tail );
+  copy_n( data.data() + first, data.size() - first, buffer_.data() );
+  size_ += data.size();
+  return data.size();
+}
+
+string_view RingStorage::peek() const
+{
+  return string_view( buffer_ ).substr( head_, min( size_, buffer_.size() - head_ ) );
+}
+
+void RingStorage::peek_all( vector<string_view>& out ) const
+{
+  const auto first = peek();
+  if ( not first.empty() ) {
+    out.push_back( first );
+  }
+  if ( first.size() < size_ ) {
+    out.push_back( string_view( buffer_ ).substr( 0, size_ - first.size() ) );
+  }
+}
+
+void RingStorage::reserve( uint64_t len, vector<span<char>>& out )
+{
+  const auto tail = ( head_ + size_ ) % buffer_.size();
+  const auto first = min( len, buffer_.size() - tail );
+  out.emplace_back( buffer_.data() + tail, first );
+  if ( first < len ) {
+    out.emplace_back( buffer_.data(), len - first );
+  }
+}
+
+void RingStorage::pop( uint64_t len )
+{
+  size_ -= len;
+  // restart at the beginning when empty, so the next peek() is as long as possible
+  head_ = size_ == 0 ? 0 : ( head_ + len ) % buffer_.size();
+}
+
+uint64_t ChunkedStorage::push( string data )
+{
+  const uint64_t len = data.size();
+  uint64_t copied = 0;
+  // don't let a short string pin a large heap allocation (e.g. a read buffer sized to the whole capacity)
+  if ( data.capacity() > 2 * len and data.capacity() > string {}.capacity() ) {
+    data.shrink_to_fit();
+    copied = len;
+  }
+  size_ += len;
+  chunks_.push_back( std::move( data ) );
+  return copied;
+}
+
+string_view ChunkedStorage::peek() const
+{
+  if ( chunks_.empty() ) {
+    return {};
+  }
+  return string_view( chunks_.front() ).substr( skip_ );
+}
+
+void ChunkedStorage::reserve( uint64_t len, vector<span<char>>& out )
+{
+  spare_.resize( len );
+  out.emplace_back( spare_.data(), len );
+}
+
+void ChunkedStorage::commit( uint64_t len )
+{
+  spare_.resize( len );
+  if ( len ) {
+    push( std::move( spare_ ) );
+  }
+  spare_ = {};
+}
+
+void ChunkedStorage::peek_all( vector<string_view>& out ) const
+{
+  auto skip = skip_;
+  for ( const auto& chunk : chunks_ ) {
+    out.push_back( string_view( chunk ).substr( skip ) );
+    skip = 0;
+  }
+}
+
+void ChunkedStorage::pop( uint64_t len )
+{
+  size_ -= len;
+  while ( len ) {
+    const auto n = min( len, chunks_.front().size() - skip_ );
+    skip_ += n;
+    len -= n;
+    if ( skip_ == chunks_.front().size() ) {
+      chunks_.pop_front();
+      skip_ = 0;
+    }
+  }
+}
+
+MirroredStorage::MirroredStorage( uint64_t capacity )
+{
+  if ( capacity == 0 ) {
+    return;
+  }
+  const auto page = static_cast<uint64_t>( sysconf( _SC_PAGESIZE ) );
+  mapped_ = ( capacity + page - 1 ) / page * page;
+
+  const int fd = CheckSystemCall( "memfd_create", memfd_create( "ByteStream", MFD_CLOEXEC ) );
+  try {
+    CheckSystemCall( "ftruncate", ftruncate( fd, static_cast<off_t>( mapped_ ) ) );
+
+    // reserve room for both copies, then map the memfd over each half
+    void* base = mmap( nullptr, 2 * mapped_, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+    if ( base == MAP_FAILED ) {
+      throw unix_error { "mmap" };
+    }
+    base_ = static_cast<char*>( base );
+    for ( const uint64_t offset : { uint64_t {}, mapped_ } ) {
+      if ( mmap( base_ + offset, mapped_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0 ) == MAP_FAILED ) {
+        throw unix_error { "mmap" };
+      }
+    }
+  } catch ( ... ) {
+    if ( base_ ) {
+      munmap( base_, 2 * mapped_ );
+    }
+    ::close( fd );
+    throw;
+  }
+  // the mappings keep the memory alive
+  ::close( fd );
+}
+
+MirroredStorage::~MirroredStorage()
+{
+  if ( base_ ) {
+    munmap( base_, 2 * mapped_ );
+  }
+}
+
+MirroredStorage::MirroredStorage( const MirroredStorage& other ) : MirroredStorage( other.mapped_ )
+{
+  if ( other.size_ ) {
+    push( std::string( other.peek() ) );
+  }
+}
+
+MirroredStorage& MirroredStorage::operator=( const MirroredStorage& other )
+{
+  if ( this != &other ) {
+    MirroredStorage copy { other };
+    swap( copy );
+  }
+  return *this;
+}
+
+MirroredStorage::MirroredStorage( MirroredStorage&& other ) noexcept
+{
+  swap( other );
+}
+
+MirroredStorage& MirroredStorage::operator=( MirroredStorage&& other ) noexcept
+{
+  MirroredStorage moved { std::move( other ) };
+  swap( moved );
+  return *this;
+}
+
+void MirroredStorage::swap( MirroredStorage& other ) noexcept
+{
+  std::swap( base_, other.base_ );
+  std::swap( mapped_, other.mapped_ );
+  std::swap( head_, other.head_ );
+  std::swap( size_, other.size_ );
+}
+
+uint64_t MirroredStorage::push( string data )
+{
+  copy_n( data.data(), data.size(), base_ + head_ + size_ );
+  size_ += data.size();
+  return data.size();
+}
+
+void MirroredStorage::peek_all( vector<string_view>& out ) const
+{
+  if ( size_ ) {
+    out.push_back( peek() );
+  }
+}
+
+void MirroredStorage::pop( uint64_t len )
+{
+  size_ -= len;
+  head_ = size_ == 0 ? 0 : ( head_ + len ) % mapped_;
+}
+
+void MirroredStorage::reserve( uint64_t len, vector<span<char>>& out )
+{
+  out.emplace_back( base_ + head_ + size_, len );
+}
+
+SlabPool& SlabPool::local()
+{
+  thread_local SlabPool pool;
+  return pool;
+}
+
+unique_ptr<SlabPool::Slab> SlabPool::acquire()
+{
+  if ( free_.empty() ) {
+    ++allocated_;
+    return make_unique<Slab>();
+  }
+  auto slab = std::move( free_.back() );
+  free_.pop_back();
+  return slab;
+}
+
+void SlabPool::release( unique_ptr<Slab> slab )
+{
+  if ( free_.size() < max_free ) {
+    free_.push_back( std::move( slab ) );
+  }
+}
+
+SlabStorage::~SlabStorage()
+{
+  for ( auto& slab : slabs_ ) {
+    SlabPool::local().release( std::move( slab ) );
+  }
+}
+
+SlabStorage::SlabStorage( const SlabStorage& other )
+{
+  vector<string_view> views;
+  other.peek_all( views );
+  for ( const auto view : views ) {
+    push( string( view ) );
+  }
+}
+
+SlabStorage::SlabStorage( SlabStorage&& other ) noexcept
+  : slabs_( std::move( other.slabs_ ) )
+  , head_( std::exchange( other.head_, 0 ) )
+  , size_( std::exchange( other.size_, 0 ) )
+{
+  other.slabs_.clear();
+}
+
+SlabStorage& SlabStorage::operator=( const SlabStorage& other )
+{
+  if ( this != &other ) {
+    SlabStorage copy { other };
+    *this = std::move( copy );
+  }
+  return *this;
+}
+
+SlabStorage& SlabStorage::operator=( SlabStorage&& other ) noexcept
+{
+  if ( this != &other ) {
+    for ( auto& slab : slabs_ ) {
+      SlabPool::local().release( std::move( slab ) );
+    }
+    slabs_ = std::move( other.slabs_ );
+    head_ = std::exchange( other.head_, 0 );
+    size_ = std::exchange( other.size_, 0 );
+    other.slabs_.clear();
+  }
+  return *this;
+}
+
+uint64_t SlabStorage::push( string data )
+{
+  vector<span<char>> regions;
+  reserve( data.size(), regions );
+  uint64_t copied = 0;
+  for ( const auto region : regions ) {
+    copy_n( data.data() + copied, region.size(), region.data() );
+    copied += region.size();
+  }
+  size_ += copied;
+  return copied;
+}
+
+string_view SlabStorage::peek() const
+{
+  if ( size_ == 0 ) {
+    return {};
+  }
+  return { slabs_.front()->data() + head_, min( size_, SlabPool::slab_size - head_ ) };
+}
+
+void SlabStorage::peek_all( vector<string_view>& out ) const
+{
+  uint64_t offset = head_;
+  uint64_t remaining = size_;
+  for ( const auto& slab : slabs_ ) {
+    if ( remaining == 0 ) {
+      break;
+    }
+    const auto len = min( remaining, SlabPool::slab_size - offset );
+    out.emplace_back( slab->data() + offset, len );
+    remaining -= len;
+    offset = 0;
+  }
+}
+
+void SlabStorage::pop( uint64_t len )
+{
+  size_ -= len;
+  head_ += len;
+  while ( head_ >= SlabPool::slab_size ) {
+    SlabPool::local().release( std::move( slabs_.front() ) );
+    slabs_.pop_front();
+    head_ -= SlabPool::slab_size;
+  }
+  trim_();
+}
+
+void SlabStorage::reserve( uint64_t len, vector<span<char>>& out )
+{
+  while ( tail_room_() < len ) {
+    slabs_.push_back( SlabPool::local().acquire() );
+  }
+  // the first free byte is in the last slab that still holds data (or in the first slab, if empty)
+  uint64_t offset = head_ + size_;
+  for ( auto& slab : slabs_ ) {
+    if ( len == 0 ) {
+      break;
+    }
+    if ( offset >= SlabPool::slab_size ) {
+      offset -= SlabPool::slab_size;
+      continue;
+    }
+    const auto n = min( len, SlabPool::slab_size - offset );
+    out.emplace_back( slab->data() + offset, n );
+    len -= n;
+    offset = 0;
+  }
+}
+
+void SlabStorage::commit( uint64_t len )
+{
+  size_ += len;
+  trim_();
+}
+
+// return slabs that hold no buffered bytes to the pool
+void SlabStorage::trim_()
+{
+  if ( size_ == 0 ) {
+    head_ = 0;
+  }
+  while ( not slabs_.empty() and tail_room_() >= SlabPool::slab_size ) {
+    SlabPool::local().release( std::move( slabs_.back() ) );
+    slabs_.pop_back();
+  }
+}
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+/*
+ * Storage backends for the bytes buffered in a ByteStream.
+ *
+ * Every backend offers the same small interface, used by ByteStream through std::visit:
+ *   size()      number of bytes buffered
+ *   push(data)  append `data` (the caller has already trimmed it to the available capacity);
+ *               returns how many bytes had to be copied (0 if the string was adopted)
+ *   peek()      view of the next buffered bytes (non-empty whenever size() > 0)
+ *   peek_all()  append views of every buffered byte, in order, to `out`
+ *   pop(len)    drop `len` bytes from the front (len <= size())
+ *   reserve(len, out)  append writable regions totalling `len` bytes (len <= free space) to `out`
+ *   commit(len)        publish the first `len` reserved bytes (len <= reserved) and drop the reservation
+ */
+
+// ContiguousStorage: all buffered bytes live in one std::string, so peek() always sees everything,
+// but pop() has to move the remaining bytes to the front.
+class ContiguousStorage
+{
+public:
+  explicit ContiguousStorage( uint64_t /* capacity */ ) {}
+
+  uint64_t size() const { return buffer_.size() - reserved_; }
+  uint64_t push( std::string data );
+  std::string_view peek() const { return std::string_view( buffer_ ).substr( 0, size() ); }
+  void peek_all( std::vector<std::string_view>& out ) const;
+  void pop( uint64_t len );
+  void reserve( uint64_t len, std::vector<std::span<char>>& out );
+  void commit( uint64_t len );
+
+private:
+  std::string buffer_ {};
+  uint64_t reserved_ {}; // bytes at the end of buffer_ handed out by reserve() but not yet committed
+};
+
+// RingStorage: a fixed-capacity circular buffer allocated once. push() and pop() only touch the bytes
+// they move, but peek() stops at the wrap point, so draining the stream may take two peeks.
+class RingStorage
+{
+public:
+  explicit RingStorage( uint64_t capacity ) : buffer_( capacity, 0 ) {}
+
+  uint64_t size() const { return size_; }
+  uint64_t push( std::string data );
+  std::string_view peek() const;
+  void peek_all( std::vector<std::string_view>& out ) const;
+  void pop( uint64_t len );
+  void reserve( uint64_t len, std::vector<std::span<char>>& out );
+  void commit( uint64_t len ) { size_ += len; }
+
+private:
+  std::string buffer_;
+  uint64_t head_ {}; // offset in buffer_ of the first buffered byte
+  uint64_t size_ {};
+};
+
+// ChunkedStorage: adopts each pushed std::string as-is, so bytes are never copied on their way through the
+// stream. peek() returns what is left of the front chunk, and pop() drops or trims chunks.
+class ChunkedStorage
+{
+public:
+  explicit ChunkedStorage( uint64_t /* capacity */ ) {}
+
+  uint64_t size() const { return size_; }
+  uint64_t push( std::string data );
+  std::string_view peek() const;
+  void peek_all( std::vector<std::string_view>& out ) const;
+  void pop( uint64_t len );
+  void reserve( uint64_t len, std::vector<std::span<char>>& out );
+  void commit( uint64_t len );
+
+private:
+  std::deque<std::string> chunks_ {};
+  uint64_t skip_ {}; // bytes already popped from chunks_.front()
+  uint64_t size_ {};
+  std::string spare_ {}; // reserved chunk, adopted by commit()
+};
+
+// MirroredStorage: a circular buffer whose memory (a memfd) is mapped twice, back to back, so the bytes
+// after the wrap point also appear right after the end of the first mapping. peek() therefore always
+// returns every buffered byte as one view, without the copying of ContiguousStorage. The allocation is
+// rounded up to whole pages; the constructor throws unix_error if the kernel refuses the mappings.
+class MirroredStorage
+{
+public:
+  explicit MirroredStorage( uint64_t capacity );
+  ~MirroredStorage();
+
+  MirroredStorage( const MirroredStorage& other );
+  MirroredStorage& operator=( const MirroredStorage& other );
+  MirroredStorage( MirroredStorage&& other ) noexcept;
+  MirroredStorage& operator=( MirroredStorage&& other ) noexcept;
+
+  uint64_t size() const { return size_; }
+  uint64_t push( std::string data );
+  std::string_view peek() const { return { base_ + head_, size_ }; }
+  void peek_all( std::vector<std::string_view>& out ) const;
+  void pop( uint64_t len );
+  void reserve( uint64_t len, std::vector<std::span<char>>& out );
+  void commit( uint64_t len ) { size_ += len; }
+
+private:
+  char* base_ {};      // start of the first of the two mappings (null if capacity is 0)
+  uint64_t mapped_ {}; // length of each mapping
+  uint64_t head_ {};   // offset from base_ of the first buffered byte (always < mapped_)
+  uint64_t size_ {};
+
+  void swap( MirroredStorage& other ) noexcept;
+};
+
+// SlabPool: a per-thread free list of fixed-size slabs, shared by every SlabStorage on that thread, so that
+// handing out and returning a slab on the hot path is a vector push/pop instead of a trip to the heap.
+class SlabPool
+{
+public:
+  static constexpr size_t slab_size = 16384; // same as FileDescriptor's read buffer
+  static constexpr size_t max_free = 1024;   // slabs kept for reuse; any more go back to the heap
+
+  using Slab = std::array<char, slab_size>;
+
+  static SlabPool& local(); // this thread's pool
+
+  std::unique_ptr<Slab> acquire();
+  void release( std::unique_ptr<Slab> slab );
+
+  uint64_t slabs_allocated() const { return allocated_; } // slabs this pool had to get from the heap
+  uint64_t slabs_free() const { return free_.size(); }
+
+private:
+  std::vector<std::unique_ptr<Slab>> free_ {};
+  uint64_t allocated_ {};
+};
+
+// SlabStorage: bytes are copied into a list of slabs drawn from this thread's SlabPool. Slabs go back to
+// the pool as soon as they are fully popped, so the memory held follows what is buffered, not the peak.
+// peek() stops at a slab boundary.
+class SlabStorage
+{
+public:
+  explicit SlabStorage( uint64_t /* capacity */ ) {}
+  ~SlabStorage();
+
+  SlabStorage( const SlabStorage& other );
+  SlabStorage& operator=( const SlabStorage& other );
+  SlabStorage( SlabStorage&& other ) noexcept;
+  SlabStorage& operator=( SlabStorage&& other ) noexcept;
+
+  uint64_t size() const { return size_; }
+  uint64_t push( std::string data );
+  std::string_view peek() const;
+  void peek_all( std::vector<std::string_view>& out ) const;
+  void pop( uint64_t len );
+  void reserve( uint64_t len, std::vector<std::span<char>>& out );
+  void commit( uint64_t len );
+
+private:
+  std::deque<std::unique_ptr<SlabPool::Slab>> slabs_ {};
+  uint64_t head_ {}; // offset in slabs_.front() of the first buffered byte
+  uint64_t size_ {};
+
+  uint64_t tail_room_() const { return slabs_.size() * SlabPool::slab_size - head_ - size_; }
+  void trim_();
+};
+
+using AnyStorage = std::variant<ContiguousStorage, RingStorage, ChunkedStorage, MirroredStorage, SlabStorage>;
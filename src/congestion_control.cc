@@ -0,0 +1,147 @@
+#include "congestion_control.hh"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace {
+
+// RFC 6928: min(10 * MSS, max(2 * MSS, 14600))
+uint64_t initial_window( uint64_t mss )
+{
+  return min( 10 * mss, max( 2 * mss, uint64_t { 14600 } ) );
+}
+
+// Spread a window over a round trip, a little faster than it drains so the window stays the limit (twice as
+// fast in slow start, as Linux does, so pacing doesn't hold back its growth)
+uint64_t pace( double cwnd, bool slow_start, optional<uint64_t> srtt_ms )
+{
+  if ( not srtt_ms or *srtt_ms == 0 ) {
+    return 0;
+  }
+  const double gain = slow_start ? 2.0 : 1.2;
+  return static_cast<uint64_t>( gain * cwnd * 1000 / static_cast<double>( *srtt_ms ) );
+}
+
+} // namespace
+
+AnyCongestionControl make_congestion_control( CongestionAlgorithm algorithm, uint64_t mss )
+{
+  switch ( algorithm ) {
+    case CongestionAlgorithm::NewReno:
+      return NewReno { mss };
+    case CongestionAlgorithm::Cubic:
+      return Cubic { mss };
+    case CongestionAlgorithm::None:
+      break;
+  }
+  return NoCongestionControl { mss };
+}
+
+NewReno::NewReno( uint64_t mss ) : mss_( mss ), cwnd_( initial_window( mss ) ) {}
+
+uint64_t NewReno::pacing_rate( optional<uint64_t> srtt_ms ) const
+{
+  return pace( static_cast<double>( cwnd_ ), cwnd_ < ssthresh_, srtt_ms );
+}
+
+void NewReno::on_ack( uint64_t acked, uint64_t /* now_ms */, optional<uint64_t> /* srtt_ms */ )
+{
+  if ( cwnd_ < ssthresh_ ) {
+    cwnd_ += min( acked, 2 * mss_ );
+    return;
+  }
+
+  bytes_acked_ += acked;
+  if ( bytes_acked_ >= cwnd_ ) {
+    bytes_acked_ -= cwnd_;
+    cwnd_ += mss_;
+  }
+}
+
+void NewReno::on_loss( uint64_t in_flight, uint64_t /* now_ms */ )
+{
+  // RFC 5681 (4): ssthresh = max(FlightSize / 2, 2 * SMSS)
+  ssthresh_ = max( in_flight / 2, 2 * mss_ );
+  cwnd_ = ssthresh_;
+  bytes_acked_ = 0;
+}
+
+void NewReno::on_rto( uint64_t in_flight, uint64_t now_ms )
+{
+  on_loss( in_flight, now_ms );
+  cwnd_ = mss_;
+}
+
+Cubic::Cubic( uint64_t mss )
+  : mss_( static_cast<double>( mss ) ), cwnd_( static_cast<double>( initial_window( mss ) ) )
+{}
+
+uint64_t Cubic::pacing_rate( optional<uint64_t> srtt_ms ) const
+{
+  return pace( cwnd_, cwnd_ < ssthresh_, srtt_ms );
+}
+
+double Cubic::w_cubic_( double t ) const
+{
+  // RFC 9438 (1): W_cubic(t) = C * (t - K)^3 + W_max, with C in MSS
+  return C * mss_ * pow( t - k_, 3 ) + w_max_;
+}
+
+void Cubic::on_ack( uint64_t acked, uint64_t now_ms, optional<uint64_t> srtt_ms )
+{
+  if ( cwnd_ < ssthresh_ ) {
+    cwnd_ += min( static_cast<double>( acked ), 2 * mss_ );
+    return;
+  }
+
+  if ( not epoch_start_ ) {
+    epoch_start_ = now_ms;
+    if ( cwnd_ < w_max_ ) {
+      k_ = cbrt( ( w_max_ - cwnd_ ) / mss_ / C );
+    } else {
+      k_ = 0;
+      w_max_ = cwnd_;
+    }
+    w_est_ = cwnd_;
+  }
+
+  const double t = static_cast<double>( now_ms - *epoch_start_ ) / 1000;
+  const double rtt = static_cast<double>( srtt_ms.value_or( 100 ) ) / 1000;
+  const double acked_bytes = static_cast<double>( acked );
+
+  // RFC 9438 4.3: the Reno-friendly window grows by alpha MSS per window acked
+  const double alpha = 3 * ( 1 - beta ) / ( 1 + beta );
+  w_est_ += alpha * mss_ * acked_bytes / cwnd_;
+
+  if ( w_cubic_( t ) < w_est_ ) {
+    cwnd_ = w_est_;
+    return;
+  }
+
+  // RFC 9438 4.4-4.5: head for the cubic window one RTT from now, but at most 1.5x the current one
+  const double target = clamp( w_cubic_( t + rtt ), cwnd_, 1.5 * cwnd_ );
+  cwnd_ += ( target - cwnd_ ) * acked_bytes / cwnd_;
+}
+
+void Cubic::reduce_()
+{
+  // RFC 9438 4.6-4.7: remember where the loss happened (less, with fast convergence, if the window had not
+  // yet got back there, so a newer flow can take its share), and cut the window by beta
+  w_max_ = cwnd_ < w_max_ ? cwnd_ * ( 1 + beta ) / 2 : cwnd_;
+  ssthresh_ = max( cwnd_ * beta, 2 * mss_ );
+  cwnd_ = ssthresh_;
+  epoch_start_.reset();
+}
+
+void Cubic::on_loss( uint64_t /* in_flight */, uint64_t /* now_ms */ )
+{
+  reduce_();
+}
+
+void Cubic::on_rto( uint64_t /* in_flight */, uint64_t /* now_ms */ )
+{
+  reduce_();
+  cwnd_ = mss_;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <variant>
+
+/*
+ * Congestion control for a TCPSender: how much it may have in flight, and how fast to send it.
+ *
+ * Every algorithm offers the same small interface, used by TCPSender through std::visit. Sizes are in bytes
+ * (sequence numbers), times in milliseconds on the sender's tick() clock:
+ *   cwnd()                        the congestion window: most bytes the sender may have in flight
+ *   pacing_rate(srtt)             bytes per second to spread transmissions at (0 = send as the window allows)
+ *   on_ack(acked, now, srtt)      an ack advanced the left edge of the window by `acked` bytes (not called
+ *                                 during fast recovery, where the window holds)
+ *   on_loss(in_flight, now)       a lost segment was detected without a timeout (duplicate acks or SACK)
+ *   on_rto(in_flight, now)        the retransmission timer expired with `in_flight` bytes outstanding (only
+ *                                 the first expiry for a segment, not each backoff after it)
+ */
+
+enum class CongestionAlgorithm
+{
+  None,    // no congestion window: fill whatever the receiver advertises
+  NewReno, // RFC 5681 slow start and congestion avoidance, with RFC 6928's initial window
+  Cubic,   // RFC 9438
+};
+
+// NoCongestionControl: an unlimited window, so only the receiver's window limits the sender.
+class NoCongestionControl
+{
+public:
+  explicit NoCongestionControl( uint64_t /* mss */ ) {}
+
+  uint64_t cwnd() const { return std::numeric_limits<uint64_t>::max(); }
+  uint64_t pacing_rate( std::optional<uint64_t> /* srtt_ms */ ) const { return 0; }
+  void on_ack( uint64_t /* acked */, uint64_t /* now_ms */, std::optional<uint64_t> /* srtt_ms */ ) {}
+  void on_loss( uint64_t /* in_flight */, uint64_t /* now_ms */ ) {}
+  void on_rto( uint64_t /* in_flight */, uint64_t /* now_ms */ ) {}
+};
+
+// NewReno: slow start grows the window by up to 2 MSS per ack (RFC 3465) until ssthresh, then congestion
+// avoidance adds 1 MSS per window acked. A loss halves the window; a timeout drops it to 1 MSS.
+class NewReno
+{
+public:
+  explicit NewReno( uint64_t mss );
+
+  uint64_t cwnd() const { return cwnd_; }
+  uint64_t pacing_rate( std::optional<uint64_t> srtt_ms ) const;
+  void on_ack( uint64_t acked, uint64_t now_ms, std::optional<uint64_t> srtt_ms );
+  void on_loss( uint64_t in_flight, uint64_t now_ms );
+  void on_rto( uint64_t in_flight, uint64_t now_ms );
+
+private:
+  uint64_t mss_;
+  uint64_t cwnd_;
+  uint64_t ssthresh_ { std::numeric_limits<uint64_t>::max() };
+  uint64_t bytes_acked_ {}; // acked in congestion avoidance since cwnd last grew
+};
+
+// Cubic: after a loss the window follows a cubic function of the time since, flat around the window where the
+// loss happened (W_max) and growing fast away from it, but never slower than NewReno would (RFC 9438).
+class Cubic
+{
+public:
+  explicit Cubic( uint64_t mss );
+
+  uint64_t cwnd() const { return static_cast<uint64_t>( cwnd_ ); }
+  uint64_t pacing_rate( std::optional<uint64_t> srtt_ms ) const;
+  void on_ack( uint64_t acked, uint64_t now_ms, std::optional<uint64_t> srtt_ms );
+  void on_loss( uint64_t in_flight, uint64_t now_ms );
+  void on_rto( uint64_t in_flight, uint64_t now_ms );
+
+private:
+  static constexpr double C = 0.4;    // in MSS per second cubed
+  static constexpr double beta = 0.7; // multiplicative decrease
+
+  double mss_;
+  double cwnd_;
+  double ssthresh_ { std::numeric_limits<double>::infinity() };
+  double w_max_ {};                    // window before the last reduction
+  double w_est_ {};                    // what NewReno's window would be in this epoch
+  double k_ {};                        // seconds from the epoch start until the window is back at w_max_
+  std::optional<uint64_t> epoch_start_ {}; // when congestion avoidance began since the last reduction
+
+  double w_cubic_( double t ) const; // the cubic window t seconds into the epoch
+  void reduce_();
+};
+
+using AnyCongestionControl = std::variant<NoCongestionControl, NewReno, Cubic>;
+
+AnyCongestionControl make_congestion_control( CongestionAlgorithm algorithm, uint64_t mss );
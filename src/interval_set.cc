@@ -0,0 +1,99 @@
+#include "interval_set.hh"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+
+bool ends_before( const IntervalSet::Interval& range, uint64_t index )
+{
+  return range.end < index;
+}
+
+bool starts_after( uint64_t index, const IntervalSet::Interval& range )
+{
+  return index < range.begin;
+}
+
+} // namespace
+
+vector<IntervalSet::Interval>::iterator IntervalSet::first_touching_( uint64_t begin )
+{
+  return lower_bound( ranges_.begin(), ranges_.end(), begin, ends_before );
+}
+
+vector<IntervalSet::Interval>::const_iterator IntervalSet::first_touching_( uint64_t begin ) const
+{
+  return lower_bound( ranges_.begin(), ranges_.end(), begin, ends_before );
+}
+
+void IntervalSet::holes( uint64_t begin, uint64_t end, vector<Interval>& out ) const
+{
+  for ( auto p = first_touching_( begin ); p != ranges_.end() && p->begin < end && begin < end; ++p ) {
+    if ( begin < p->begin )
+      out.push_back( { begin, p->begin } );
+    begin = max( begin, p->end );
+  }
+  if ( begin < end )
+    out.push_back( { begin, end } );
+}
+
+void IntervalSet::add( uint64_t begin, uint64_t end, vector<Interval>& filled )
+{
+  if ( begin >= end )
+    return;
+
+  const auto before = filled.size();
+  holes( begin, end, filled );
+  for ( auto p = filled.begin() + static_cast<ptrdiff_t>( before ); p != filled.end(); ++p ) {
+    size_ += p->end - p->begin;
+  }
+
+  // merge [begin, end) with every range it overlaps or touches
+  const auto first = first_touching_( begin );
+  const auto last = upper_bound( first, ranges_.end(), end, starts_after );
+  if ( first == last ) {
+    ranges_.insert( first, { begin, end } );
+    return;
+  }
+  first->begin = min( first->begin, begin );
+  first->end = max( prev( last )->end, end );
+  ranges_.erase( next( first ), last );
+}
+
+optional<IntervalSet::Interval> IntervalSet::find( uint64_t index ) const
+{
+  const auto p = upper_bound( ranges_.begin(), ranges_.end(), index, starts_after );
+  if ( p == ranges_.begin() || prev( p )->end <= index )
+    return nullopt;
+  return *prev( p );
+}
+
+void IntervalSet::remove_below( uint64_t index )
+{
+  auto p = ranges_.begin();
+  for ( ; p != ranges_.end() && p->begin < index; ++p ) {
+    if ( p->end > index ) {
+      size_ -= index - p->begin;
+      p->begin = index;
+      break;
+    }
+    size_ -= p->end - p->begin;
+  }
+  ranges_.erase( ranges_.begin(), p );
+}
+
+void IntervalSet::remove_from( uint64_t index )
+{
+  while ( !ranges_.empty() && ranges_.back().end > index ) {
+    auto& last = ranges_.back();
+    if ( last.begin < index ) {
+      size_ -= last.end - index;
+      last.end = index;
+      break;
+    }
+    size_ -= last.end - last.begin;
+    ranges_.pop_back();
+  }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+/*
+ * IntervalSet: a set of stream indices, stored as the sorted list of maximal [begin, end) ranges it covers.
+ * The ranges live in one flat vector, so finding where an interval goes is a binary search and walking the
+ * ranges it touches stays within a few cache lines, even with thousands of holes between them.
+ */
+class IntervalSet
+{
+public:
+  struct Interval
+  {
+    uint64_t begin;
+    uint64_t end;
+  };
+
+  // Add [begin, end). The parts that were not in the set yet (the holes it fills) are appended to `filled`.
+  void add( uint64_t begin, uint64_t end, std::vector<Interval>& filled );
+
+  // Append the parts of [begin, end) that are not in the set to `out`.
+  void holes( uint64_t begin, uint64_t end, std::vector<Interval>& out ) const;
+
+  // The range holding `index`, if any.
+  std::optional<Interval> find( uint64_t index ) const;
+
+  // Remove every index below `index`.
+  void remove_below( uint64_t index );
+
+  // Remove every index at or above `index`.
+  void remove_from( uint64_t index );
+
+  uint64_t size() const { return size_; } // number of indices in the set
+  bool empty() const { return ranges_.empty(); }
+  const Interval& front() const { return ranges_.front(); }
+  const std::vector<Interval>& ranges() const { return ranges_; }
+
+private:
+  std::vector<Interval> ranges_ {}; // sorted, non-overlapping and non-adjacent
+  uint64_t size_ {};
+
+  // the first range that ends at or after `begin`
+  std::vector<Interval>::iterator first_touching_( uint64_t begin );
+  std::vector<Interval>::const_iterator first_touching_( uint64_t begin ) const;
+};
@@ -0,0 +1,55 @@
+#include "pending_budget.hh"
+
+#include <utility>
+
+using namespace std;
+
+PendingCharge::PendingCharge( const PendingCharge& other ) : budget_( other.budget_ )
+{
+  set( other.amount_ );
+}
+
+PendingCharge& PendingCharge::operator=( const PendingCharge& other )
+{
+  if ( this != &other ) {
+    set( 0 );
+    budget_ = other.budget_;
+    set( other.amount_ );
+  }
+  return *this;
+}
+
+PendingCharge::PendingCharge( PendingCharge&& other ) noexcept
+  : budget_( std::move( other.budget_ ) ), amount_( exchange( other.amount_, 0 ) )
+{}
+
+PendingCharge& PendingCharge::operator=( PendingCharge&& other ) noexcept
+{
+  if ( this != &other ) {
+    set( 0 );
+    budget_ = std::move( other.budget_ );
+    amount_ = exchange( other.amount_, 0 );
+  }
+  return *this;
+}
+
+uint64_t PendingCharge::room_for_us() const
+{
+  if ( not budget_ ) {
+    return UINT64_MAX;
+  }
+  const auto others = budget_->used() - amount_;
+  return others < budget_->limit() ? budget_->limit() - others : 0;
+}
+
+void PendingCharge::set( uint64_t amount )
+{
+  if ( budget_ ) {
+    if ( amount > amount_ ) {
+      budget_->add( amount - amount_ );
+    } else {
+      budget_->remove( amount_ - amount );
+    }
+  }
+  amount_ = amount;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+/*
+ * PendingBudget: a limit on the memory held by a group of Reassemblers (e.g. every connection in the
+ * process), shared through a std::shared_ptr. Each Reassembler records its share with a PendingCharge and
+ * evicts its own bytes when the group goes over the limit. Thread-safe.
+ */
+class PendingBudget
+{
+public:
+  explicit PendingBudget( uint64_t limit ) : limit_( limit ) {}
+
+  uint64_t limit() const { return limit_; }
+  uint64_t used() const { return used_.load( std::memory_order_relaxed ); }
+
+  void add( uint64_t n ) { used_.fetch_add( n, std::memory_order_relaxed ); }
+  void remove( uint64_t n ) { used_.fetch_sub( n, std::memory_order_relaxed ); }
+
+private:
+  uint64_t limit_;
+  std::atomic<uint64_t> used_ {};
+};
+
+// PendingCharge: the bytes one Reassembler has counted against a PendingBudget, given back on destruction.
+// A copy charges the same amount again; a move takes the charge over.
+class PendingCharge
+{
+public:
+  PendingCharge() = default;
+  explicit PendingCharge( std::shared_ptr<PendingBudget> budget ) : budget_( std::move( budget ) ) {}
+  ~PendingCharge() { set( 0 ); }
+
+  PendingCharge( const PendingCharge& other );
+  PendingCharge& operator=( const PendingCharge& other );
+  PendingCharge( PendingCharge&& other ) noexcept;
+  PendingCharge& operator=( PendingCharge&& other ) noexcept;
+
+  const PendingBudget* budget() const { return budget_.get(); }
+  uint64_t amount() const { return amount_; }
+
+  // How far the other holders of the budget leave it from its limit (0 if already over)
+  uint64_t room_for_us() const;
+
+  void set( uint64_t amount ); // charge `amount` bytes in total
+
+private:
+  std::shared_ptr<PendingBudget> budget_ {};
+  uint64_t amount_ {};
+};
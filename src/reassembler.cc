@@ -1,26 +1,64 @@
 #include "reassembler.hh"
+#include <algorithm>
 #include <cstdint>
+#include <memory>
+#include <ostream>
 #include <utility>
+#include <variant>
 
 using namespace std;
 
+namespace {
+
+AnyEngine make_engine( uint64_t capacity, Reassembler::Engine engine )
+{
+  if ( engine == Reassembler::Engine::Bitmap )
+    return BitmapEngine { capacity };
+  return MapEngine { capacity };
+}
+
+} // namespace
+
+// the stream can hold at most its capacity, however much of it is buffered right now
+Reassembler::Reassembler( ByteStream&& output, Engine engine )
+  : output_( std::move( output ) )
+  , engine_( make_engine( output_.writer().available_capacity() + output_.reader().bytes_buffered(), engine ) )
+{}
+
 void Reassembler::insert( uint64_t first_index, string data, bool is_last_substring )
 {
   // Your code here.
   if ( output_.writer().is_closed() )
     return;
 
+  store_( first_index, std::move( data ), is_last_substring );
+  flush();
+  evict_();
+}
+
+void Reassembler::flush()
+{
+  if ( output_.writer().is_closed() )
+    return;
+
+  // everything that has become contiguous with the stream
+  while ( std::visit( [&]( auto& engine ) { return engine.flush_to( output_.writer() ); }, engine_ ) > 0 ) {}
+  charge_.set( bytes_retained() );
+
+  // close the writer
+  if ( output_.writer().bytes_pushed() == end_index_ ) {
+    output_.writer().close();
+  }
+}
+
+void Reassembler::store_( uint64_t first_index, string data, bool is_last_substring )
+{
   // get an alias
   const auto out_index = output_.writer().bytes_pushed();
 
   // set end_index
   if ( is_last_substring && end_index_ == 0xffffffff ) {
     end_index_ = first_index + data.size();
-    // close the writer
-    if ( out_index == end_index_ ) {
-      output_.writer().close();
-      return;
-    }
   }
 
   if ( data.size() == 0 )
@@ -34,84 +72,136 @@ void Reassembler::insert( uint64_t first_index, string data, bool is_last_substr
     }
     return p;
   }();
-  if ( width == 0 )
-    return;
 
-  // [out, out + width - 1] comp [first, first + size - 1]
-  if ( first_index > out_index + width - 1 )
+  // [out, out + width) comp [first, first + size)
+  if ( first_index + data.size() <= out_index ) {
+    stats_.duplicate_bytes += data.size();
     return;
-  if ( first_index + data.size() - 1 < out_index )
-    return;
-  if ( first_index < out_index ) {
-    data = data.substr( out_index - first_index, data.size() - ( out_index - first_index ) );
-    first_index = out_index;
   }
-  if ( first_index + data.size() - 1 > out_index + width - 1 ) {
-    // len = datasize - (first + size - out - wid)
-    data = data.substr( 0, out_index + width - first_index );
+  if ( width == 0 || first_index >= out_index + width ) {
+    stats_.bytes_dropped += data.size();
+    return;
   }
 
-  // insert elem to map
-  auto [p, v] = unassemble_subs_.insert( pair( first_index, "" ) );
-  if ( !v ) {
-    auto q = unassemble_subs_.find( first_index );
-    if ( q->second.size() > data.size() )
-      return;
-    pending_ += data.size() - q->second.size();
-    q->second = std::move( data );
-    p = q;
-  } else {
-    pending_ += data.size();
-    p->second = std::move( data );
+  // trim to the window by offsets into data, without copying
+  const uint64_t skip = first_index < out_index ? out_index - first_index : 0;
+  uint64_t len = min( first_index + data.size(), out_index + width ) - ( first_index + skip );
+  stats_.bytes_dropped += data.size() - skip - len;
+
+  // in-order bytes with nothing held back can go straight to the stream
+  if ( first_index + skip == out_index && bytes_pending() == 0 ) {
+    stats_.overlap_bytes += skip;
+    data.resize( skip + len );
+    data.erase( 0, skip );
+    output_.writer().push( std::move( data ) );
+    return;
   }
 
-  // forward check
-  if ( p != unassemble_subs_.begin() ) {
-    auto pre = p;
-    --pre;
-    if ( p->first + p->second.size() <= pre->first + pre->second.size() ) {
-      pending_ -= p->second.size();
-      unassemble_subs_.erase( p );
-      return;
-    }
-    if ( p->first < pre->first + pre->second.size() ) {
-      const auto delta = pre->first + pre->second.size() - p->first;
-      pending_ -= delta; // pending_ add psize above
-      pre->second += p->second.substr( delta, p->second.size() - delta );
-      std::swap( p, pre );
-      unassemble_subs_.erase( pre );
+  // (bytes at the next index are about to be written, so they never count against a limit)
+  uint64_t offset = skip;
+  if ( limits_.eviction == Eviction::Incoming && first_index + skip != out_index ) {
+    const auto room = room_() - min( room_(), bytes_retained() );
+    if ( len > room ) {
+      // keep a copy of just the part that fits, so the rest of the payload isn't held in memory either
+      stats_.bytes_dropped += len - room;
+      len = room;
+      if ( len == 0 )
+        return;
+      data = data.substr( skip, len );
+      offset = 0;
     }
   }
 
-  // next check
-  auto q = p;
-  ++q;
-  while ( q != unassemble_subs_.end() && q->first + q->second.size() <= p->first + p->second.size() ) {
-    pending_ -= q->second.size();
-    q = unassemble_subs_.erase( q );
+  // remember where it went, for recent_ranges()
+  static constexpr size_t max_recent = 8;
+  recent_.insert( recent_.begin(), first_index + skip );
+  if ( recent_.size() > max_recent )
+    recent_.pop_back();
+
+  const auto before = bytes_pending();
+  Slice slice { std::make_shared<string>( std::move( data ) ), offset, len };
+  std::visit( [&]( auto& engine ) { engine.insert( first_index + skip, std::move( slice ) ); }, engine_ );
+  const auto added = bytes_pending() - before;
+  if ( added == 0 ) {
+    stats_.duplicate_bytes += skip + len;
+  } else {
+    stats_.overlap_bytes += skip + len - added;
   }
-  while ( q != unassemble_subs_.end() && q->first <= p->first + p->second.size() ) {
-    auto delta = p->first + p->second.size() - q->first;
-    pending_ -= delta;
-    p->second += q->second.substr( delta, q->second.size() - delta );
-    q = unassemble_subs_.erase( q );
+}
+
+// over a limit: forget the bytes furthest from the next index until the memory they occupy fits (forgetting a
+// slice frees nothing while another slice still shares its payload, so this may take more than one round)
+void Reassembler::evict_()
+{
+  const auto begin = output_.writer().bytes_pushed();
+  const auto end = begin + output_.writer().available_capacity();
+  while ( bytes_retained() > room_() ) {
+    const auto excess = bytes_retained() - room_();
+    const auto evicted
+      = std::visit( [&]( auto& engine ) { return engine.evict_furthest( excess, begin, end ); }, engine_ );
+    stats_.bytes_dropped += evicted;
+    if ( evicted == 0 )
+      break;
   }
+  charge_.set( bytes_retained() );
+}
+
+uint64_t Reassembler::room_() const
+{
+  return min( limits_.max_pending, charge_.room_for_us() );
+}
 
-  // can output
-  if ( unassemble_subs_.begin()->first == out_index ) {
-    pending_ -= unassemble_subs_.begin()->second.size();
-    output_.writer().push( std::move( unassemble_subs_.begin()->second ) );
-    unassemble_subs_.erase( unassemble_subs_.begin() );
+void Reassembler::set_limits( Limits limits )
+{
+  limits_ = std::move( limits );
+  charge_ = PendingCharge { limits_.shared };
+  charge_.set( bytes_retained() );
+}
+
+void Reassembler::recent_ranges( vector<IntervalSet::Interval>& out, size_t max ) const
+{
+  const auto first = out.size();
+  for ( const auto index : recent_ ) {
+    if ( out.size() - first == max )
+      break;
+    if ( index < output_.writer().bytes_pushed() )
+      continue;
+    const auto range
+      = std::visit( [&]( const auto& engine ) { return engine.range_containing( index ); }, engine_ );
+    const auto seen = [&]( const IntervalSet::Interval& r ) { return r.begin == range->begin; };
+    if ( range && std::none_of( out.begin() + static_cast<ptrdiff_t>( first ), out.end(), seen ) )
+      out.push_back( *range );
   }
 
-  // close the writer
-  if ( output_.writer().bytes_pushed() == end_index_ ) {
-    output_.writer().close();
+  // only the last few stores are remembered, so report the ranges they no longer reach as well (RFC 2018 4)
+  const auto begin = output_.writer().bytes_pushed();
+  const auto end = begin + output_.writer().available_capacity();
+  auto index = begin;
+  while ( out.size() - first < max ) {
+    const auto range
+      = std::visit( [&]( const auto& engine ) { return engine.range_after( index, end ); }, engine_ );
+    if ( !range )
+      break;
+    const auto seen = [&]( const IntervalSet::Interval& r ) { return r.begin == range->begin; };
+    if ( std::none_of( out.begin() + static_cast<ptrdiff_t>( first ), out.end(), seen ) )
+      out.push_back( *range );
+    index = range->end;
   }
 }
 
 uint64_t Reassembler::bytes_pending() const
 {
   // Your code here.
-  return pending_;
+  return std::visit( []( const auto& engine ) { return engine.pending(); }, engine_ );
+}
+
+uint64_t Reassembler::bytes_retained() const
+{
+  return std::visit( []( const auto& engine ) { return engine.retained(); }, engine_ );
+}
+
+ostream& operator<<( ostream& out, const Reassembler::Stats& stats )
+{
+  return out << "bytes_dropped=" << stats.bytes_dropped << " duplicate_bytes=" << stats.duplicate_bytes
+             << " overlap_bytes=" << stats.overlap_bytes;
 }
@@ -1,15 +1,50 @@
 #pragma once
 
 #include "byte_stream.hh"
+#include "pending_budget.hh"
+#include "reassembler_engine.hh"
 #include <cstdint>
-#include <map>
+#include <iosfwd>
+#include <memory>
 #include <sys/types.h>
+#include <vector>
 
 class Reassembler
 {
 public:
+  // How the bytes waiting for earlier gaps are held (see reassembler_engine.hh)
+  enum class Engine
+  {
+    Map,    // slices of the received payloads, indexed by an IntervalSet
+    Bitmap, // capacity-sized ring plus a presence bitmap, allocated once
+  };
+
+  // What to discard when the stored bytes would go over a limit
+  enum class Eviction
+  {
+    Furthest, // the stored bytes furthest from the next index (possibly the ones just received)
+    Incoming, // whatever of each new substring does not fit
+  };
+
+  // Limits on the memory occupied by the bytes stored in the Reassembler (bytes_retained()), on top of the
+  // stream's available capacity
+  struct Limits
+  {
+    uint64_t max_pending = UINT64_MAX;        // for this Reassembler alone
+    std::shared_ptr<PendingBudget> shared {}; // for every Reassembler given the same budget
+    Eviction eviction = Eviction::Furthest;
+  };
+
+  // Where the bytes received went, other than into the stream
+  struct Stats
+  {
+    uint64_t bytes_dropped {};   // beyond the window, or over a limit
+    uint64_t duplicate_bytes {}; // in substrings that brought no new bytes at all
+    uint64_t overlap_bytes {};   // already received, trimmed from substrings that brought some new bytes
+  };
+
   // Construct Reassembler to write into given ByteStream.
-  explicit Reassembler( ByteStream&& output ) : output_( std::move( output ) ) {}
+  explicit Reassembler( ByteStream&& output, Engine engine = Engine::Map );
 
   /*
    * Insert a new substring to be reassembled into a ByteStream.
@@ -33,9 +68,28 @@ public:
    */
   void insert( uint64_t first_index, std::string data, bool is_last_substring );
 
+  /*
+   * Write every stored byte that is now contiguous with the stream, and close the stream if that reaches its
+   * end. insert() already does this; call it again after the reader frees capacity.
+   */
+  void flush();
+
   // How many bytes are stored in the Reassembler itself?
   uint64_t bytes_pending() const;
 
+  // How many bytes of memory do they occupy (with the rest of any payload they share)?
+  uint64_t bytes_retained() const;
+
+  /*
+   * Append up to `max` of the ranges of stream indices stored in the Reassembler to `out`, in the order
+   * RFC 2018 wants SACK blocks: the range holding the most recently stored substring first, then the ranges
+   * of the substrings stored before it, then any other ranges held, lowest first.
+   */
+  void recent_ranges( std::vector<IntervalSet::Interval>& out, size_t max ) const;
+
+  void set_limits( Limits limits );
+  const Stats& stats() const { return stats_; }
+
   // Access output stream reader
   Reader& reader() { return output_.reader(); }
   const Reader& reader() const { return output_.reader(); }
@@ -45,7 +99,16 @@ public:
 
 private:
   ByteStream output_; // the Reassembler writes to this ByteStream
-  uint64_t pending_ {};
   uint64_t end_index_ = 0xffffffff;
-  std::map<uint64_t, std::string> unassemble_subs_ {};
+  AnyEngine engine_;
+  std::vector<uint64_t> recent_ {}; // first index of the most recently stored substrings, newest first
+  Limits limits_ {};
+  PendingCharge charge_ {}; // bytes_retained() as counted against limits_.shared
+  Stats stats_ {};
+
+  void store_( uint64_t first_index, std::string data, bool is_last_substring );
+  void evict_();
+  uint64_t room_() const; // how many bytes may be stored in total
 };
+
+std::ostream& operator<<( std::ostream& out, const Reassembler::Stats& stats );
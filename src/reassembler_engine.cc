@@ -0,0 +1,292 @@
+#include "reassembler_engine.hh"
+
+#include <algorithm>
+#include <bit>
+#include <utility>
+
+using namespace std;
+
+string Slice::release()
+{
+  if ( buffer.use_count() > 1 )
+    return std::string( view() );
+  buffer->resize( offset + length );
+  buffer->erase( 0, offset );
+  return std::move( *buffer );
+}
+
+void MapEngine::insert( uint64_t first_index, Slice data )
+{
+  filled_.clear();
+  ranges_.add( first_index, first_index + data.length, filled_ );
+  if ( filled_.empty() )
+    return;
+
+  // new bytes that are less than half of the payload are copied out together, so that filling small holes
+  // can't keep a large payload alive
+  uint64_t filled = 0;
+  for ( const auto& hole : filled_ )
+    filled += hole.end - hole.begin;
+  const bool compact = 2 * filled < data.buffer->size();
+  auto buffer = data.buffer;
+  if ( compact ) {
+    buffer = make_shared<string>();
+    buffer->reserve( filled );
+    for ( const auto& hole : filled_ )
+      buffer->append( data.view().substr( hole.begin - first_index, hole.end - hole.begin ) );
+  }
+
+  uint64_t copied = 0;
+  for ( const auto& hole : filled_ ) {
+    const auto offset = compact ? copied : data.offset + hole.begin - first_index;
+    unassemble_subs_.emplace( hole.begin, Slice { buffer, offset, hole.end - hole.begin } );
+    copied += hole.end - hole.begin;
+  }
+  retained_ += buffer->size();
+}
+
+uint64_t MapEngine::flush_to( Writer& writer )
+{
+  const auto out_index = writer.bytes_pushed();
+  if ( ranges_.empty() || ranges_.front().begin != out_index )
+    return 0;
+
+  const auto ready = ranges_.front().end;
+  while ( !unassemble_subs_.empty() && unassemble_subs_.begin()->first < ready ) {
+    auto slice = std::move( unassemble_subs_.extract( unassemble_subs_.begin() ).mapped() );
+    forget_( slice );
+    writer.push( slice.release() );
+  }
+  ranges_.remove_below( ready );
+  return ready - out_index;
+}
+
+optional<IntervalSet::Interval> MapEngine::range_after( uint64_t index, uint64_t end ) const
+{
+  const auto& ranges = ranges_.ranges();
+  const auto starts_after = []( uint64_t i, const IntervalSet::Interval& r ) { return i < r.begin; };
+  const auto p = upper_bound( ranges.begin(), ranges.end(), index, starts_after );
+  if ( p == ranges.end() || p->begin >= end )
+    return nullopt;
+  return *p;
+}
+
+uint64_t MapEngine::evict_furthest( uint64_t bytes, uint64_t /* begin */, uint64_t /* end */ )
+{
+  // find the index above which `bytes` bytes are held
+  uint64_t cut = UINT64_MAX;
+  uint64_t left = bytes;
+  for ( auto p = ranges_.ranges().rbegin(); p != ranges_.ranges().rend() && left > 0; ++p ) {
+    const auto len = min( left, p->end - p->begin );
+    cut = p->end - len;
+    left -= len;
+  }
+  if ( cut == UINT64_MAX )
+    return 0;
+
+  ranges_.remove_from( cut );
+  for ( auto p = unassemble_subs_.lower_bound( cut ); p != unassemble_subs_.end(); ) {
+    forget_( p->second );
+    p = unassemble_subs_.erase( p );
+  }
+  // the slice the cut falls in keeps a copy of what is left of it, so the evicted bytes are freed
+  if ( !unassemble_subs_.empty() ) {
+    auto& [first, slice] = *unassemble_subs_.rbegin();
+    if ( cut - first < slice.length ) {
+      Slice rest { make_shared<string>( slice.view().substr( 0, cut - first ) ), 0, cut - first };
+      forget_( slice );
+      slice = std::move( rest );
+      retained_ += slice.length;
+    }
+  }
+  return bytes - left;
+}
+
+void MapEngine::forget_( const Slice& slice )
+{
+  if ( slice.buffer.use_count() == 1 )
+    retained_ -= slice.buffer->size();
+}
+
+BitmapEngine::BitmapEngine( uint64_t capacity ) : ring_( capacity, 0 ), present_( ( capacity + 63 ) / 64, 0 ) {}
+
+void BitmapEngine::insert( uint64_t first_index, Slice slice )
+{
+  // the window is never wider than the ring, so the bytes land in at most two pieces
+  const auto data = slice.view();
+  const auto begin = first_index % ring_.size();
+  const auto first = min( data.size(), ring_.size() - begin );
+  copy_n( data.data(), first, ring_.data() + begin );
+  copy_n( data.data() + first, data.size() - first, ring_.data() );
+  pending_ += set_bits_( begin, begin + first ) + set_bits_( 0, data.size() - first );
+}
+
+uint64_t BitmapEngine::flush_to( Writer& writer )
+{
+  if ( pending_ == 0 )
+    return 0;
+
+  const auto begin = writer.bytes_pushed() % ring_.size();
+  auto len = count_run_( begin, ring_.size() );
+  if ( begin + len == ring_.size() )
+    len += count_run_( 0, begin );
+  if ( len == 0 )
+    return 0;
+
+  uint64_t copied = 0;
+  for ( const auto region : writer.reserve( len ) ) {
+    const auto from = ( begin + copied ) % ring_.size();
+    const auto first = min( region.size(), ring_.size() - from );
+    copy_n( ring_.data() + from, first, region.data() );
+    copy_n( ring_.data(), region.size() - first, region.data() + first );
+    copied += region.size();
+  }
+  writer.commit( len );
+
+  const auto first = min( len, ring_.size() - begin );
+  clear_bits_( begin, begin + first );
+  clear_bits_( 0, len - first );
+  pending_ -= len;
+  return len;
+}
+
+optional<IntervalSet::Interval> BitmapEngine::range_containing( uint64_t index ) const
+{
+  if ( pending_ == 0 )
+    return nullopt;
+
+  // the byte at the writer's next index is never held (it would have been flushed), so neither scan can go all
+  // the way around
+  const auto pos = index % ring_.size();
+  auto after = count_run_( pos, ring_.size() );
+  if ( after == 0 )
+    return nullopt;
+  if ( pos + after == ring_.size() )
+    after += count_run_( 0, pos );
+  auto before = count_run_back_( pos );
+  if ( before == pos )
+    before += count_run_back_( ring_.size() );
+  return IntervalSet::Interval { index - before, index + after };
+}
+
+optional<IntervalSet::Interval> BitmapEngine::range_after( uint64_t index, uint64_t end ) const
+{
+  if ( pending_ == 0 )
+    return nullopt;
+
+  // skip the gap from `index` in ring order, wrapping around at most once ([index, end) is never wider than
+  // the ring)
+  const auto width = end - index;
+  const auto pos = index % ring_.size();
+  auto gap = count_gap_( pos, min( ring_.size(), pos + width ) );
+  if ( pos + gap == ring_.size() && gap < width )
+    gap += count_gap_( 0, width - gap );
+  if ( gap >= width )
+    return nullopt;
+  return range_containing( index + gap );
+}
+
+uint64_t BitmapEngine::evict_furthest( uint64_t bytes, uint64_t begin, uint64_t end )
+{
+  // [begin, end) is never wider than the ring; clear from the top of its part after the wrap point first
+  const auto from = begin % ring_.size();
+  const auto to = from + ( end - begin );
+  uint64_t evicted = 0;
+  if ( to > ring_.size() )
+    evicted += clear_top_bits_( 0, to - ring_.size(), bytes );
+  evicted += clear_top_bits_( from, min( to, ring_.size() ), bytes - evicted );
+  pending_ -= evicted;
+  return evicted;
+}
+
+uint64_t BitmapEngine::set_bits_( uint64_t begin, uint64_t end )
+{
+  uint64_t added = 0;
+  while ( begin < end ) {
+    const auto shift = begin % 64;
+    const auto n = min( end - begin, 64 - shift );
+    const auto mask = ( n == 64 ? ~uint64_t {} : ( ( uint64_t { 1 } << n ) - 1 ) ) << shift;
+    auto& word = present_[begin / 64];
+    added += popcount( mask & ~word );
+    word |= mask;
+    begin += n;
+  }
+  return added;
+}
+
+void BitmapEngine::clear_bits_( uint64_t begin, uint64_t end )
+{
+  while ( begin < end ) {
+    const auto shift = begin % 64;
+    const auto n = min( end - begin, 64 - shift );
+    const auto mask = ( n == 64 ? ~uint64_t {} : ( ( uint64_t { 1 } << n ) - 1 ) ) << shift;
+    present_[begin / 64] &= ~mask;
+    begin += n;
+  }
+}
+
+uint64_t BitmapEngine::clear_top_bits_( uint64_t begin, uint64_t end, uint64_t limit )
+{
+  uint64_t cleared = 0;
+  while ( end > begin && cleared < limit ) {
+    const auto lo = max( begin, ( end - 1 ) / 64 * 64 );
+    const auto n = end - lo;
+    const auto mask = ( n == 64 ? ~uint64_t {} : ( ( uint64_t { 1 } << n ) - 1 ) ) << ( lo % 64 );
+    auto& word = present_[lo / 64];
+    auto held = word & mask;
+    if ( static_cast<uint64_t>( popcount( held ) ) <= limit - cleared ) {
+      cleared += popcount( held );
+      word &= ~held;
+    } else {
+      while ( cleared < limit ) {
+        const auto top = uint64_t { 1 } << ( 63 - countl_zero( held ) );
+        held &= ~top;
+        word &= ~top;
+        ++cleared;
+      }
+    }
+    end = lo;
+  }
+  return cleared;
+}
+
+uint64_t BitmapEngine::count_run_( uint64_t begin, uint64_t end ) const
+{
+  // bits past the end of the ring are never set, so the scan always stops inside present_
+  auto pos = begin;
+  while ( pos < end ) {
+    const auto shift = pos % 64;
+    const auto ones = static_cast<uint64_t>( countr_one( present_[pos / 64] >> shift ) );
+    pos += ones;
+    if ( ones < 64 - shift )
+      break;
+  }
+  return min( pos, end ) - begin;
+}
+
+uint64_t BitmapEngine::count_gap_( uint64_t begin, uint64_t end ) const
+{
+  auto pos = begin;
+  while ( pos < end ) {
+    const auto shift = pos % 64;
+    const auto zeros = static_cast<uint64_t>( countr_zero( present_[pos / 64] >> shift ) );
+    pos += zeros;
+    if ( zeros < 64 - shift )
+      break;
+  }
+  return min( pos, end ) - begin;
+}
+
+uint64_t BitmapEngine::count_run_back_( uint64_t end ) const
+{
+  auto pos = end;
+  while ( pos > 0 ) {
+    const auto shift = 64 - ( ( pos - 1 ) % 64 + 1 ); // unused high bits of the word holding bit pos - 1
+    const auto ones = static_cast<uint64_t>( countl_one( present_[( pos - 1 ) / 64] << shift ) );
+    const auto available = 64 - shift;
+    pos -= min( ones, available );
+    if ( ones < available )
+      break;
+  }
+  return end - pos;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "byte_stream.hh"
+#include "interval_set.hh"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+// Slice: `length` bytes at `offset` in a payload shared by every slice cut from it, so trimming a segment or
+// splitting it around bytes already held copies nothing. (When a segment's new bytes are less than half of its
+// payload, MapEngine copies them out together instead, so a small hole fill can't keep a large payload alive.)
+struct Slice
+{
+  std::shared_ptr<std::string> buffer;
+  uint64_t offset;
+  uint64_t length;
+
+  std::string_view view() const { return std::string_view( *buffer ).substr( offset, length ); }
+
+  // The bytes as a string of their own. If no other slice shares the payload, it is trimmed in place and
+  // handed over instead of copied.
+  std::string release();
+};
+
+/*
+ * Engines that hold the bytes a Reassembler has received but cannot write yet.
+ *
+ * Every engine offers the same small interface, used by Reassembler through std::visit:
+ *   pending()          number of distinct bytes held
+ *   retained()         bytes of memory holding them (a held slice keeps its whole payload alive)
+ *   insert(first, data)  remember the bytes of slice `data` at stream index `first` (the caller has already
+ *                        trimmed it to the window the stream can accept, and it is non-empty)
+ *   flush_to(writer)   write the bytes held from writer.bytes_pushed() onwards, as far as they are contiguous,
+ *                      and forget them; returns how many bytes were written
+ *   range_containing(index)  the maximal run of held bytes that includes `index`, if it is held
+ *                            (index >= the writer's bytes_pushed())
+ *   range_after(index, end)  the first maximal run of held bytes past `index`, which is not held itself, that
+ *                            starts before `end` (both within the window the stream can accept)
+ *   evict_furthest(bytes, begin, end)  forget up to `bytes` held bytes, the highest indices first (every held
+ *                                      byte lies in [begin, end)); returns how many were forgotten
+ */
+
+// MapEngine: slices of the received payloads, keyed by their first index and never overlapping, plus an
+// IntervalSet of the indices they cover. A new segment only adds slices for the holes the IntervalSet says it
+// fills, and flush_to() pushes each ready slice in turn, handing over whole payloads without copying them.
+class MapEngine
+{
+public:
+  explicit MapEngine( uint64_t /* capacity */ ) {}
+
+  uint64_t pending() const { return ranges_.size(); }
+  uint64_t retained() const { return retained_; }
+  void insert( uint64_t first_index, Slice data );
+  uint64_t flush_to( Writer& writer );
+  std::optional<IntervalSet::Interval> range_containing( uint64_t index ) const { return ranges_.find( index ); }
+  std::optional<IntervalSet::Interval> range_after( uint64_t index, uint64_t end ) const;
+  uint64_t evict_furthest( uint64_t bytes, uint64_t begin, uint64_t end );
+
+private:
+  IntervalSet ranges_ {};
+  std::vector<IntervalSet::Interval> filled_ {}; // scratch space for insert()
+  std::map<uint64_t, Slice> unassemble_subs_ {};
+  uint64_t retained_ {}; // total size of the payloads the slices share
+
+  void forget_( const Slice& slice ); // account for `slice` being dropped
+};
+
+// BitmapEngine: a ring of `capacity` bytes indexed by stream index (mod capacity), preallocated once, and a
+// bitmap with one bit per ring byte marking which bytes are present. insert() copies the bytes in and sets
+// their bits; flush_to() finds the contiguous prefix a 64-bit word at a time and copies it straight into the
+// writer's reserved space, so neither allocates.
+class BitmapEngine
+{
+public:
+  explicit BitmapEngine( uint64_t capacity );
+
+  uint64_t pending() const { return pending_; }
+  uint64_t retained() const { return pending_; }
+  void insert( uint64_t first_index, Slice data );
+  uint64_t flush_to( Writer& writer );
+  std::optional<IntervalSet::Interval> range_containing( uint64_t index ) const;
+  std::optional<IntervalSet::Interval> range_after( uint64_t index, uint64_t end ) const;
+  uint64_t evict_furthest( uint64_t bytes, uint64_t begin, uint64_t end );
+
+private:
+  std::string ring_;
+  std::vector<uint64_t> present_;
+  uint64_t pending_ {};
+
+  uint64_t set_bits_( uint64_t begin, uint64_t end );   // returns how many bits were newly set
+  void clear_bits_( uint64_t begin, uint64_t end );
+  uint64_t clear_top_bits_( uint64_t begin, uint64_t end, uint64_t limit ); // clear up to `limit` set bits
+  uint64_t count_run_( uint64_t begin, uint64_t end ) const; // number of consecutive set bits from `begin`
+  uint64_t count_gap_( uint64_t begin, uint64_t end ) const; // ... clear bits
+  uint64_t count_run_back_( uint64_t end ) const;           // ... ending just before `end`, not past bit 0
+};
+
+using AnyEngine = std::variant<MapEngine, BitmapEngine>;
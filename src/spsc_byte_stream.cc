@@ -0,0 +1,164 @@
+#include "spsc_byte_stream.hh"
+
+#include "exception.hh"
+
+#include <algorithm>
+#include <stdexcept>
+#include <sys/eventfd.h>
+
+using namespace std;
+
+namespace {
+
+FileDescriptor make_eventfd()
+{
+  return FileDescriptor { CheckSystemCall( "eventfd", ::eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC ) ) };
+}
+
+} // namespace
+
+SPSCByteStream::SPSCByteStream( uint64_t capacity, bool with_events ) : buffer_( capacity, 0 )
+{
+  if ( with_events ) {
+    readable_event_.emplace( make_eventfd() );
+    writable_event_.emplace( make_eventfd() );
+  }
+}
+
+uint64_t SPSCByteStream::push( string_view data )
+{
+  if ( closed_.load( memory_order_relaxed ) ) {
+    return 0;
+  }
+
+  const uint64_t tail = pushed_.load( memory_order_relaxed ); // only this thread writes pushed_
+  const uint64_t head = popped_.load( memory_order_acquire ); // bytes before head are free to overwrite
+  const uint64_t len = min( static_cast<uint64_t>( data.size() ), buffer_.size() - ( tail - head ) );
+  if ( len == 0 ) {
+    return 0;
+  }
+
+  const uint64_t offset = tail % buffer_.size();
+  const uint64_t first = min( len, buffer_.size() - offset );
+  copy_n( data.data(), first, buffer_.data() + offset );
+  copy_n( data.data() + first, len - first, buffer_.data() );
+
+  pushed_.store( tail + len, memory_order_seq_cst );
+
+  // Wake the reader if it may have seen the stream empty. The seq_cst store above and load below pair with
+  // the ones in pop(): either the reader sees the new bytes, or we see that it had caught up with `tail`.
+  if ( readable_event_ and popped_.load( memory_order_seq_cst ) == tail ) {
+    signal( readable_event_ );
+  }
+  return len;
+}
+
+void SPSCByteStream::close()
+{
+  closed_.store( true, memory_order_release );
+  signal( readable_event_ );
+}
+
+uint64_t SPSCByteStream::available_capacity() const
+{
+  return buffer_.size() - bytes_buffered();
+}
+
+uint64_t SPSCByteStream::bytes_pushed() const
+{
+  return pushed_.load( memory_order_acquire );
+}
+
+string_view SPSCByteStream::peek() const
+{
+  const uint64_t head = popped_.load( memory_order_relaxed ); // only this thread writes popped_
+  const uint64_t tail = pushed_.load( memory_order_acquire ); // bytes before tail have been written
+  if ( head == tail ) {
+    return {};
+  }
+  const uint64_t offset = head % buffer_.size();
+  return string_view( buffer_ ).substr( offset, min( tail - head, buffer_.size() - offset ) );
+}
+
+void SPSCByteStream::pop( uint64_t len )
+{
+  const uint64_t head = popped_.load( memory_order_relaxed );
+  const uint64_t tail = pushed_.load( memory_order_acquire );
+  len = min( len, tail - head );
+  if ( len == 0 ) {
+    return;
+  }
+
+  popped_.store( head + len, memory_order_seq_cst );
+
+  // Wake the writer if it may have seen the stream full (see push()).
+  if ( writable_event_ and pushed_.load( memory_order_seq_cst ) == head + buffer_.size() ) {
+    signal( writable_event_ );
+  }
+}
+
+bool SPSCByteStream::is_finished() const
+{
+  // closed_ is set after the last push, so once it is visible so are all the pushed bytes
+  return closed_.load( memory_order_acquire ) and bytes_buffered() == 0;
+}
+
+uint64_t SPSCByteStream::bytes_popped() const
+{
+  return popped_.load( memory_order_acquire );
+}
+
+bool SPSCByteStream::is_closed() const
+{
+  return closed_.load( memory_order_acquire );
+}
+
+uint64_t SPSCByteStream::bytes_buffered() const
+{
+  // load popped_ first: it never passes pushed_, so the difference can't underflow
+  const uint64_t head = popped_.load( memory_order_acquire );
+  return pushed_.load( memory_order_acquire ) - head;
+}
+
+void SPSCByteStream::set_error()
+{
+  error_.store( true, memory_order_release );
+  signal( readable_event_ );
+  signal( writable_event_ );
+}
+
+bool SPSCByteStream::has_error() const
+{
+  return error_.load( memory_order_acquire );
+}
+
+FileDescriptor& SPSCByteStream::readable_event()
+{
+  if ( not readable_event_ ) {
+    throw runtime_error( "SPSCByteStream was constructed without events" );
+  }
+  return *readable_event_;
+}
+
+FileDescriptor& SPSCByteStream::writable_event()
+{
+  if ( not writable_event_ ) {
+    throw runtime_error( "SPSCByteStream was constructed without events" );
+  }
+  return *writable_event_;
+}
+
+void SPSCByteStream::clear_event( FileDescriptor& event )
+{
+  string counter( sizeof( uint64_t ), 0 );
+  event.read( counter ); // non-blocking: leaves the eventfd at zero whether or not it was signalled
+}
+
+void SPSCByteStream::signal( optional<FileDescriptor>& event )
+{
+  if ( event ) {
+    const uint64_t one = 1;
+    const auto* bytes = reinterpret_cast<const char*>( &one ); // NOLINT(*-reinterpret-cast)
+    event->write( string_view( bytes, sizeof( one ) ) );
+  }
+}
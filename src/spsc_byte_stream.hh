@@ -0,0 +1,70 @@
+#pragma once
+
+#include "file_descriptor.hh"
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+/*
+ * SPSCByteStream: a fixed-capacity ByteStream that one producer thread and one consumer thread may use
+ * at the same time without locks. The producer calls the "writer side" methods and the consumer the
+ * "reader side" methods; the counters (bytes pushed/popped) are atomics, and the bytes between them live
+ * in a circular buffer, so handing bytes across threads costs one memcpy and no syscalls.
+ *
+ * Optionally, two eventfds let each side sleep in poll()/EventLoop until the other side makes progress:
+ * `readable_event()` is signalled when bytes arrive in an empty stream (or it is closed or errored),
+ * `writable_event()` when space frees up in a full stream. Call clear_event() on the fd before
+ * re-checking the stream.
+ */
+class SPSCByteStream
+{
+public:
+  explicit SPSCByteStream( uint64_t capacity, bool with_events = false );
+
+  // Writer side
+  uint64_t push( std::string_view data ); // Push as much of `data` as fits; returns the number of bytes pushed
+  void close();                           // Signal that nothing more will be written
+  uint64_t available_capacity() const;    // How many bytes can be pushed right now?
+  uint64_t bytes_pushed() const;          // Total number of bytes cumulatively pushed
+
+  // Reader side
+  std::string_view peek() const; // Peek at the next bytes in the buffer (stops at the wrap point)
+  void pop( uint64_t len );      // Remove `len` bytes from the buffer
+  bool is_finished() const;      // Is the stream finished (closed and fully popped)?
+  uint64_t bytes_popped() const; // Total number of bytes cumulatively popped
+
+  // Either side
+  bool is_closed() const;
+  uint64_t bytes_buffered() const;
+  void set_error();
+  bool has_error() const;
+
+  // Wakeup eventfds (throw if the stream was built without them)
+  FileDescriptor& readable_event();
+  FileDescriptor& writable_event();
+  static void clear_event( FileDescriptor& event );
+
+  // Shared between two threads, so neither copyable nor movable
+  SPSCByteStream( const SPSCByteStream& other ) = delete;
+  SPSCByteStream& operator=( const SPSCByteStream& other ) = delete;
+  SPSCByteStream( SPSCByteStream&& other ) = delete;
+  SPSCByteStream& operator=( SPSCByteStream&& other ) = delete;
+  ~SPSCByteStream() = default;
+
+private:
+  std::string buffer_;
+
+  // Each counter is written by one side only; keep them on separate cache lines.
+  alignas( 64 ) std::atomic<uint64_t> pushed_ {};
+  alignas( 64 ) std::atomic<uint64_t> popped_ {};
+  alignas( 64 ) std::atomic<bool> closed_ {};
+  std::atomic<bool> error_ {};
+
+  std::optional<FileDescriptor> readable_event_ {};
+  std::optional<FileDescriptor> writable_event_ {};
+
+  void signal( std::optional<FileDescriptor>& event );
+};
@@ -17,22 +17,48 @@ void TCPReceiver::receive( TCPSenderMessage message )
       return 0;
     return message.seqno.unwrap( zero_point_ + 1, reassembler_.writer().bytes_pushed() );
   }();
-  reassembler_.insert( insert_index, message.payload, message.FIN );
+  reassembler_.insert( insert_index, message.payload.release(), message.FIN );
 }
 
-TCPReceiverMessage TCPReceiver::send() const
+TCPReceiverMessage TCPReceiver::send( bool syn ) const
 {
   // Your code here.
   const auto ackno = initialized_zero_point_ ? std::optional<Wrap32>(
                        zero_point_ + 1 + reassembler_.writer().bytes_pushed() + reassembler_.writer().is_closed() )
                                              : std::nullopt;
-  const auto window_size = reassembler_.writer().available_capacity() > UINT16_MAX
-                             ? (uint16_t)UINT16_MAX
-                             : (uint16_t)reassembler_.writer().available_capacity();
+  // the window of a SYN is never scaled
+  const auto window = reassembler_.writer().available_capacity() >> ( syn ? 0 : window_shift_() );
+  const auto window_size = window > UINT16_MAX ? (uint16_t)UINT16_MAX : (uint16_t)window;
   const auto need_reset = reassembler_.reader().has_error();
+  std::vector<TCPReceiverMessage::SACKBlock> sack;
+  if ( initialized_zero_point_ and sack_offered_ and peer_sack_ ) {
+    std::vector<IntervalSet::Interval> ranges;
+    reassembler_.recent_ranges( ranges, TCPReceiverMessage::MAX_SACK_BLOCKS );
+    for ( const auto& range : ranges ) {
+      // stream index + 1 (for the SYN) is the absolute seqno
+      const auto begin = Wrap32::wrap( range.begin + 1, zero_point_ );
+      const auto end = Wrap32::wrap( range.end + 1, zero_point_ );
+      sack.push_back( { begin, end } );
+    }
+  }
+  // a SYN answering the peer's may offer window scaling only if the peer's did (RFC 7323 2.2)
+  const bool offer_window_scale = syn and ( not initialized_zero_point_ or peer_window_scale_ );
   return TCPReceiverMessage {
     ackno,
     window_size,
     need_reset,
+    std::move( sack ),
+    offer_window_scale ? window_scale_ : std::nullopt,
+    syn ? mss_ : std::nullopt,
+    syn and sack_offered_,
   };
 }
+
+void TCPReceiver::offer_window_scale()
+{
+  uint8_t shift = 0;
+  while ( shift < TCPReceiverMessage::MAX_WINDOW_SCALE
+          and ( reassembler_.writer().available_capacity() >> shift ) > UINT16_MAX )
+    ++shift;
+  window_scale_ = shift;
+}
@@ -17,7 +17,30 @@ public:
   void receive( TCPSenderMessage message );
 
   // The TCPReceiver sends TCPReceiverMessages to the peer's TCPSender.
-  TCPReceiverMessage send() const;
+  // With `syn`, the message goes out alongside our SYN: it carries any MSS, window scale and SACK offer, unscaled.
+  TCPReceiverMessage send( bool syn = false ) const;
+
+  // Offer window scaling (RFC 7323), with the smallest shift that lets the window cover the whole capacity
+  // (once the peer's SYN has arrived, only if it offered window scaling too)
+  void offer_window_scale();
+
+  // Advertise the largest payload we want in one segment
+  void advertise_mss( uint16_t mss ) { mss_ = mss; }
+
+  // Whether the peer's SYN offered window scaling too (our windows are scaled only if it did)
+  void set_peer_window_scale( bool offered ) { peer_window_scale_ = offered; }
+
+  // Offer SACK (RFC 2018)
+  void offer_sack() { sack_offered_ = true; }
+
+  // Whether the peer's SYN offered SACK too (we send SACK blocks only if it did)
+  void set_peer_sack( bool offered ) { peer_sack_ = offered; }
+
+  // Move any reassembled bytes into the stream (call after the application has read from it)
+  void flush() { reassembler_.flush(); }
+
+  // Limit the out-of-order bytes held by the Reassembler
+  void set_reassembler_limits( Reassembler::Limits limits ) { reassembler_.set_limits( std::move( limits ) ); }
 
   // Access the output (only Reader is accessible non-const)
   const Reassembler& reassembler() const { return reassembler_; }
@@ -29,4 +52,11 @@ private:
   Reassembler reassembler_;
   Wrap32 zero_point_ { 0 };
   bool initialized_zero_point_ {};
+  std::optional<uint8_t> window_scale_ {}; // shift we offer
+  bool peer_window_scale_ {};
+  std::optional<uint16_t> mss_ {}; // MSS we advertise
+  bool sack_offered_ {};
+  bool peer_sack_ {};
+
+  uint8_t window_shift_() const { return peer_window_scale_ ? window_scale_.value_or( 0 ) : 0; }
 };
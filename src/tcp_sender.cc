@@ -1,8 +1,14 @@
 #include "tcp_sender.hh"
 #include "tcp_config.hh"
 #include "tcp_sender_message.hh"
+#include <algorithm>
 #include <cstdint>
+#include <iterator>
 #include <netinet/in.h>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
 
 using namespace std;
 
@@ -18,11 +24,54 @@ uint64_t TCPSender::consecutive_retransmissions() const
   return retransmission_time_;
 }
 
+uint64_t TCPSender::cwnd() const
+{
+  return visit( []( const auto& cc ) { return cc.cwnd(); }, congestion_ );
+}
+
+uint64_t TCPSender::pacing_rate() const
+{
+  if ( !pacing_ )
+    return 0;
+  const auto SRTT = timer_.SRTT_ms();
+  return visit( [&]( const auto& cc ) { return cc.pacing_rate( SRTT ); }, congestion_ );
+}
+
+uint64_t TCPSender::mss() const
+{
+  return min( mss_, peer_mss_.value_or( mss_ ) );
+}
+
+void TCPSender::set_congestion_control( CongestionAlgorithm algorithm, bool pacing )
+{
+  congestion_algorithm_ = algorithm;
+  congestion_ = make_congestion_control( algorithm, mss() );
+  pacing_ = pacing;
+}
+
+void TCPSender::set_mss( uint64_t mss )
+{
+  mss_ = max( mss, static_cast<uint64_t>( 1 ) );
+  congestion_ = make_congestion_control( congestion_algorithm_, this->mss() );
+}
+
 void TCPSender::push( const TransmitFunction& transmit )
 {
   // Your code here.
-  const auto window_size = max( window_size_, static_cast<uint64_t>( 1 ) );
-  while ( sequence_numbers_in_flight() < window_size ) {
+  const auto paced = pacing_rate() > 0;
+  // bytes in the network: the same as those in flight, unless recovery knows some have left it
+  auto pipe = pipe_();
+  if ( recovery_point_ )
+    retransmit_lost_( transmit, pipe );
+  // the receiver's window (probed with 1 byte when zero), further limited by the congestion window
+  const auto receive_window = max( window_size_, static_cast<uint64_t>( 1 ) );
+  const auto congestion_window = cwnd();
+  const auto room = [&]() {
+    if ( sequence_numbers_in_flight() >= receive_window || pipe >= congestion_window )
+      return static_cast<uint64_t>( 0 );
+    return min( receive_window - sequence_numbers_in_flight(), congestion_window - pipe );
+  };
+  while ( room() > 0 && !( paced && pacing_credit_ == 0 ) ) {
     const auto s = input_.reader().peek();
     auto msg = make_empty_message();
     if ( !is_initialized_ ) {
@@ -30,15 +79,16 @@ void TCPSender::push( const TransmitFunction& transmit )
       is_initialized_ = true;
     }
     const auto payload_size = [&]() {
-      const auto windows_free_space
-        = static_cast<uint64_t>( min( window_size - sequence_numbers_in_flight(), TCPConfig::MAX_PAYLOAD_SIZE ) );
+      // the MSS counts options too, so the payload makes room for those going with it (RFC 6691)
+      const auto option_bytes = msg.SYN ? syn_option_bytes_ : option_bytes_;
+      const auto max_payload = mss() > option_bytes ? mss() - option_bytes : 1;
+      const auto windows_free_space = min( room(), max_payload );
       const auto payload_upper = windows_free_space - msg.sequence_length();
       return static_cast<uint64_t>( min( payload_upper, s.size() ) );
     }();
-    msg.payload = s.substr( 0, payload_size );
+    msg.payload = string( s.substr( 0, payload_size ) );
     input_.reader().pop( payload_size );
-    if ( !is_closed_ && input_.reader().is_finished()
-         && window_size > sequence_numbers_in_flight() + msg.sequence_length() ) {
+    if ( !is_closed_ && input_.reader().is_finished() && room() > msg.sequence_length() ) {
       msg.FIN = true;
       is_closed_ = true;
     }
@@ -47,9 +97,14 @@ void TCPSender::push( const TransmitFunction& transmit )
       break;
     insert_buffer_( send_index_, msg );
     transmit( msg );
+    pipe += msg.sequence_length();
+    if ( paced )
+      pacing_credit_ -= min( pacing_credit_, msg.sequence_length() );
+    if ( !timed_segment_ )
+      timed_segment_ = { send_index_, now_ms_ };
     if ( timer_.is_closed() ) {
       timer_.reset();
-      timer_.reset_RTO( initial_RTO_ms_ );
+      timer_.reset_RTO();
     }
   }
 }
@@ -60,16 +115,28 @@ TCPSenderMessage TCPSender::make_empty_message() const
   return TCPSenderMessage {
     isn_ + send_index_,
     false,
-    "",
+    {},
     false,
     input_.has_error(),
   };
 }
 
-void TCPSender::receive( const TCPReceiverMessage& msg )
+void TCPSender::receive( const TCPReceiverMessage& msg, bool carries_data )
 {
   // Your code here.
-  window_size_ = msg.window_size;
+  const auto last_window_size = window_size_;
+  // a window scale comes with the peer's SYN, whose own window is unscaled: taken before our SYN is acked, as
+  // one on a later segment must be ignored (RFC 7323 2.2)
+  const bool handshake_scale = msg.window_scale && receive_index_ == 0;
+  window_size_ = static_cast<uint64_t>( msg.window_size ) << ( handshake_scale ? 0 : window_shift_ );
+  if ( handshake_scale )
+    window_shift_ = min( *msg.window_scale, TCPReceiverMessage::MAX_WINDOW_SCALE );
+  // so does its MSS, which the congestion window is counted in: taken once, before our SYN is acked, so a
+  // duplicate SYN can't start the window over
+  if ( msg.mss && *msg.mss > 0 && !peer_mss_ && receive_index_ == 0 ) {
+    peer_mss_ = *msg.mss;
+    congestion_ = make_congestion_control( congestion_algorithm_, mss() );
+  }
   if ( msg.RST )
     input_.set_error();
   if ( !msg.ackno.has_value() ) {
@@ -78,20 +145,47 @@ void TCPSender::receive( const TCPReceiverMessage& msg )
   }
   // sendindex relative to isn_, and 0 preserve for SYN
   const auto ackno_abs = msg.ackno->unwrap( isn_, receive_index_ );
-  if ( ackno_abs <= receive_index_ || ackno_abs > send_index_ ) {
+  if ( ackno_abs < receive_index_ || ackno_abs > send_index_ ) {
     return;
   }
-  auto i = outstanding_seg_.begin();
-  while ( i != outstanding_seg_.end() && i->first + i->second.sequence_length() <= ackno_abs ) {
-    i++;
+  const bool new_sack = fast_retransmit_ && record_sack_( msg.sack, ackno_abs );
+  if ( ackno_abs == receive_index_ ) {
+    // A duplicate ack (RFC 5681 2): nothing newly acked though data is outstanding, and no data or window
+    // update to explain it -- or, with SACK, news of data that arrived beyond a hole (RFC 6675 2).
+    if ( fast_retransmit_ && receive_index_ > 0 && sequence_numbers_in_flight() > 0 && !carries_data
+         && ( new_sack || ( msg.sack.empty() && window_size_ == last_window_size ) ) ) {
+      ++dup_acks_;
+      detect_loss_();
+    }
+    return;
   }
-  outstanding_seg_.erase( outstanding_seg_.begin(), i );
+  while ( !outstanding_seg_.empty()
+          && outstanding_seg_.front().first + outstanding_seg_.front().second.sequence_length() <= ackno_abs ) {
+    outstanding_seg_.pop_front();
+  }
+  const auto acked = ackno_abs - receive_index_;
   receive_index_ = ackno_abs;
+  while ( !sacked_.empty() && sacked_.begin()->second <= ackno_abs ) {
+    sacked_.erase( sacked_.begin() );
+  }
+  if ( timed_segment_ && ackno_abs >= timed_segment_->first ) {
+    timer_.sample_RTT( now_ms_ - timed_segment_->second );
+    timed_segment_.reset();
+  }
+  const auto SRTT = timer_.SRTT_ms();
+  // the window holds at ssthresh through fast recovery, up to and including the ack that ends it (RFC 6582 3.2)
+  if ( !recovery_point_ || !fast_recovery_ )
+    visit( [&]( auto& cc ) { cc.on_ack( acked, now_ms_, SRTT ); }, congestion_ );
+  // a partial ack (RFC 6582) keeps recovery going, and push() resends the segment now at the front
+  dup_acks_ = 0;
+  if ( recovery_point_ && ackno_abs >= *recovery_point_ )
+    recovery_point_.reset();
+  detect_loss_();
   retransmission_time_ = 0;
+  timer_.reset_RTO();
   if ( sequence_numbers_in_flight() == 0 ) {
     timer_.close();
   } else {
-    timer_.reset_RTO( initial_RTO_ms_ );
     timer_.reset();
   }
 }
@@ -99,24 +193,153 @@ void TCPSender::receive( const TCPReceiverMessage& msg )
 void TCPSender::tick( uint64_t ms_since_last_tick, const TransmitFunction& transmit )
 {
   // Your code here.
+  now_ms_ += ms_since_last_tick;
   timer_.pass( ms_since_last_tick );
+  if ( const auto rate = pacing_rate() ) {
+    // refill the pacing credit, but don't let it build up past one tick's worth (or two segments)
+    const auto refill = rate * ms_since_last_tick / 1000;
+    pacing_credit_ = min( pacing_credit_ + refill, max( refill, 2 * mss() ) );
+  }
   if ( timer_.is_activated() ) {
     if ( !outstanding_seg_.empty() && retransmission_time_ < TCPConfig::TIMEOUT_DFLT) {
-      transmit( outstanding_seg_.begin()->second );
+      transmit( outstanding_seg_.front().second );
+      // Karn's rule: an ack after a retransmission can't tell which transmission it answers
+      timed_segment_.reset();
       if ( window_size_ != 0) {
         timer_.double_RTO();
+        // a zero-window probe going unanswered says nothing about congestion, and nor does backing off again
+        // for the same segment: only the first timeout cuts the window (RFC 5681 3.1)
+        const auto in_flight = sequence_numbers_in_flight();
+        if ( retransmission_time_ == 0 )
+          visit( [&]( auto& cc ) { cc.on_rto( in_flight, now_ms_ ); }, congestion_ );
+        if ( fast_retransmit_ ) {
+          // go on to repair the other holes the scoreboard shows as acks come back (RFC 6675 5.1), in slow start
+          recovery_point_ = send_index_;
+          fast_recovery_ = false;
+          high_rxt_ = outstanding_seg_.front().first + outstanding_seg_.front().second.sequence_length();
+          dup_acks_ = 0;
+        }
       }
       ++retransmission_time_;
     }
   };
+  // send whatever the refilled pacing credit now allows
+  if ( pacing_rate() )
+    push( transmit );
 }
 
-void TCPSender::insert_buffer_( uint64_t index, TCPSenderMessage msg )
+void TCPSender::insert_buffer_( uint64_t index, const TCPSenderMessage& msg )
 {
-  outstanding_seg_.insert( pair( index, msg ) );
+  // the copy shares the payload with the transmitted message
+  outstanding_seg_.emplace_back( index, msg );
   send_index_ += msg.sequence_length();
 }
 
+bool TCPSender::record_sack_( const vector<TCPReceiverMessage::SACKBlock>& sack, uint64_t ackno )
+{
+  bool news = false;
+  for ( const auto& block : sack ) {
+    auto begin = block.begin.unwrap( isn_, ackno );
+    auto end = block.end.unwrap( isn_, ackno );
+    if ( begin <= ackno || end <= begin || end > send_index_ || is_sacked_( begin, end ) )
+      continue;
+    news = true;
+    // merge with every range it touches
+    auto i = sacked_.upper_bound( begin );
+    if ( i != sacked_.begin() && prev( i )->second >= begin )
+      --i;
+    while ( i != sacked_.end() && i->first <= end ) {
+      begin = min( begin, i->first );
+      end = max( end, i->second );
+      i = sacked_.erase( i );
+    }
+    sacked_.emplace( begin, end );
+  }
+  return news;
+}
+
+bool TCPSender::is_sacked_( uint64_t begin, uint64_t end ) const
+{
+  auto i = sacked_.upper_bound( begin );
+  return i != sacked_.begin() && prev( i )->second >= end;
+}
+
+// Walk the outstanding segments from the last sent back to the first, telling `on_segment` whether each has
+// been SACKed and whether it is presumed lost: with DUP_THRESH SACKed segments sent after it (RFC 6675 IsLost),
+// or, in recovery, at the front.
+template<typename F>
+void TCPSender::scoreboard_( F&& on_segment ) const
+{
+  uint64_t sacked_after = 0;
+  for ( auto i = outstanding_seg_.rbegin(); i != outstanding_seg_.rend(); ++i ) {
+    const auto& [index, seg] = *i;
+    const bool sacked = is_sacked_( index, index + seg.sequence_length() );
+    const bool front = next( i ) == outstanding_seg_.rend();
+    on_segment( index, seg, sacked, !sacked && ( sacked_after >= DUP_THRESH || ( recovery_point_ && front ) ) );
+    sacked_after += sacked ? 1 : 0;
+  }
+}
+
+void TCPSender::detect_loss_()
+{
+  if ( !fast_retransmit_ || recovery_point_ || outstanding_seg_.empty() )
+    return;
+  if ( dup_acks_ < DUP_THRESH ) {
+    const uint64_t sacked = count_if( outstanding_seg_.begin(), outstanding_seg_.end(), [&]( const auto& seg ) {
+      return is_sacked_( seg.first, seg.first + seg.second.sequence_length() );
+    } );
+    if ( sacked < DUP_THRESH )
+      return;
+  }
+  // enter recovery: halve the window, and have push() resend the front segment at once
+  recovery_point_ = send_index_;
+  fast_recovery_ = true;
+  high_rxt_ = outstanding_seg_.front().first;
+  const auto in_flight = sequence_numbers_in_flight();
+  visit( [&]( auto& cc ) { cc.on_loss( in_flight, now_ms_ ); }, congestion_ );
+}
+
+// RFC 6675 SetPipe: outstanding bytes not SACKed count once unless presumed lost, and once more if resent
+uint64_t TCPSender::pipe_() const
+{
+  if ( !recovery_point_ )
+    return sequence_numbers_in_flight();
+  uint64_t pipe = 0;
+  scoreboard_( [&]( uint64_t index, const TCPSenderMessage& seg, bool sacked, bool lost ) {
+    if ( sacked )
+      return;
+    pipe += ( lost ? 0 : seg.sequence_length() ) + ( index < high_rxt_ ? seg.sequence_length() : 0 );
+  } );
+  // without SACK, each duplicate ack still tells of a segment that has left the network
+  if ( sacked_.empty() )
+    pipe -= min( pipe, dup_acks_ * mss() );
+  return pipe;
+}
+
+// RFC 6675 NextSeg rule 1: resend the lost segments not yet resent in this recovery, oldest first, while the
+// pipe has room -- except the one at the front, which goes at once (RFC 6675 4.3, RFC 6582 partial acks)
+void TCPSender::retransmit_lost_( const TransmitFunction& transmit, uint64_t& pipe )
+{
+  vector<pair<uint64_t, const TCPSenderMessage*>> lost;
+  scoreboard_( [&]( uint64_t index, const TCPSenderMessage& seg, bool /* sacked */, bool is_lost ) {
+    if ( is_lost && index >= high_rxt_ )
+      lost.emplace_back( index, &seg );
+  } );
+  const auto paced = pacing_rate() > 0;
+  for ( auto i = lost.rbegin(); i != lost.rend(); ++i ) {
+    const auto& [index, seg] = *i;
+    if ( index != outstanding_seg_.front().first && ( pipe >= cwnd() || ( paced && pacing_credit_ == 0 ) ) )
+      break;
+    transmit( *seg );
+    high_rxt_ = index + seg->sequence_length();
+    pipe += seg->sequence_length();
+    if ( paced )
+      pacing_credit_ -= min( pacing_credit_, seg->sequence_length() );
+    // Karn's rule
+    timed_segment_.reset();
+  }
+}
+
 void RetransmissionsTimer::pass( uint64_t passed_ms )
 {
   if ( close_ )
@@ -140,13 +363,60 @@ bool RetransmissionsTimer::is_activated()
 void RetransmissionsTimer::double_RTO()
 {
   RTO_ms_ *= 2;
+  if ( limits_ )
+    RTO_ms_ = min( RTO_ms_, limits_->second );
 }
 
-void RetransmissionsTimer::reset_RTO( uint64_t initial_RTO_ms )
+void RetransmissionsTimer::reset_RTO()
 {
-  RTO_ms_ = initial_RTO_ms;
+  RTO_ms_ = base_RTO_ms_;
 };
 
+void RetransmissionsTimer::set_RTO_limits( uint64_t min_RTO_ms, uint64_t max_RTO_ms )
+{
+  limits_ = { min_RTO_ms, max( min_RTO_ms, max_RTO_ms ) };
+  update_base_RTO_();
+}
+
+void RetransmissionsTimer::sample_RTT( uint64_t RTT_ms )
+{
+  if ( !has_sample_ ) {
+    // RFC 6298 2.2: SRTT = R, RTTVAR = R/2
+    SRTT_x8_ = RTT_ms * 8;
+    RTTVAR_x4_ = RTT_ms * 2;
+    has_sample_ = true;
+  } else {
+    // RFC 6298 2.3: RTTVAR = 3/4 RTTVAR + 1/4 |SRTT - R|, then SRTT = 7/8 SRTT + 1/8 R
+    const auto SRTT = SRTT_x8_ / 8;
+    const auto error = SRTT > RTT_ms ? SRTT - RTT_ms : RTT_ms - SRTT;
+    RTTVAR_x4_ = RTTVAR_x4_ - RTTVAR_x4_ / 4 + error;
+    SRTT_x8_ = SRTT_x8_ - SRTT + RTT_ms;
+  }
+  update_base_RTO_();
+}
+
+void RetransmissionsTimer::update_base_RTO_()
+{
+  if ( !limits_ || !has_sample_ )
+    return;
+  // RFC 6298 2.3-2.5: RTO = SRTT + max(G, 4 * RTTVAR), within the limits
+  base_RTO_ms_ = clamp( SRTT_x8_ / 8 + max( clock_granularity_ms, RTTVAR_x4_ ), limits_->first, limits_->second );
+}
+
+optional<uint64_t> RetransmissionsTimer::SRTT_ms() const
+{
+  if ( !has_sample_ )
+    return nullopt;
+  return SRTT_x8_ / 8;
+}
+
+optional<uint64_t> RetransmissionsTimer::RTTVAR_ms() const
+{
+  if ( !has_sample_ )
+    return nullopt;
+  return RTTVAR_x4_ / 4;
+}
+
 void RetransmissionsTimer::reset()
 {
   tick_ms_ = 0;
@@ -1,19 +1,25 @@
 #pragma once
 
 #include "byte_stream.hh"
+#include "congestion_control.hh"
+#include "tcp_config.hh"
 #include "tcp_receiver_message.hh"
 #include "tcp_sender_message.hh"
 #include "wrapping_integers.hh"
 
 #include <cstdint>
+#include <deque>
 #include <functional>
 #include <map>
+#include <optional>
+#include <vector>
 
 class RetransmissionsTimer
 {
 public:
-  RetransmissionsTimer( uint64_t initial_RTO_ms = 0 ) : RTO_ms_( initial_RTO_ms ) {};
-  void reset_RTO( uint64_t initial_RTO_ms );
+  RetransmissionsTimer( uint64_t initial_RTO_ms = 0 )
+    : RTO_ms_( initial_RTO_ms ), base_RTO_ms_( initial_RTO_ms ) {};
+  void reset_RTO(); // undo any doubling
   void pass( uint64_t passed_ms );
   bool is_activated();
   bool is_closed();
@@ -21,11 +27,27 @@ public:
   void reset();
   void close();
 
+  // RTT estimation (RFC 6298). Samples always update the estimates, but only once limits are set does the
+  // RTO follow them (SRTT + 4 * RTTVAR, clamped); until then it stays at the initial RTO.
+  void set_RTO_limits( uint64_t min_RTO_ms, uint64_t max_RTO_ms );
+  void sample_RTT( uint64_t RTT_ms );
+  uint64_t RTO_ms() const { return RTO_ms_; }
+  std::optional<uint64_t> SRTT_ms() const;
+  std::optional<uint64_t> RTTVAR_ms() const;
+
 private:
   uint64_t tick_ms_ {};
   uint64_t RTO_ms_;
+  uint64_t base_RTO_ms_; // RTO before any doubling
   bool active_ {};
   bool close_ {};
+
+  static constexpr uint64_t clock_granularity_ms = 1;
+  std::optional<std::pair<uint64_t, uint64_t>> limits_ {}; // min and max RTO
+  bool has_sample_ {};
+  uint64_t SRTT_x8_ {};   // SRTT * 8 and RTTVAR * 4, so that the 1/8 and 1/4 gains keep their precision
+  uint64_t RTTVAR_x4_ {};
+  void update_base_RTO_();
 };
 
 class TCPSender
@@ -33,14 +55,40 @@ class TCPSender
 public:
   /* Construct TCP sender with given default Retransmission Timeout and possible ISN */
   TCPSender( ByteStream&& input, Wrap32 isn, uint64_t initial_RTO_ms )
-    : input_( std::move( input ) ), isn_( isn ), initial_RTO_ms_( initial_RTO_ms ), timer_( initial_RTO_ms )
+    : input_( std::move( input ) ), isn_( isn ), timer_( initial_RTO_ms )
   {}
 
+  /* Limit the bytes in flight with a congestion window (none by default), optionally paced over the RTT */
+  void set_congestion_control( CongestionAlgorithm algorithm, bool pacing = false );
+
+  /* Largest payload to send in one segment (TCPConfig::MAX_PAYLOAD_SIZE by default), or less if the peer's
+     SYN advertises a smaller MSS. Set it before connecting: the congestion window starts over. */
+  void set_mss( uint64_t mss );
+
+  /* Bytes of TCP options that go with each new segment (none by default): `syn` on the SYN, `other` on the
+     rest. A segment's payload is cut short to leave room for them within the MSS (RFC 6691). */
+  void set_option_bytes( uint64_t syn, uint64_t other )
+  {
+    syn_option_bytes_ = syn;
+    option_bytes_ = other;
+  }
+
+  /* Let the RTO adapt to the measured round-trip time (RFC 6298), within the given limits */
+  void set_RTO_limits( uint64_t min_RTO_ms, uint64_t max_RTO_ms )
+  {
+    timer_.set_RTO_limits( min_RTO_ms, max_RTO_ms );
+  }
+
+  /* Resend lost segments without waiting for the RTO: after three duplicate acks (RFC 5681 fast retransmit,
+     RFC 6582 NewReno recovery), or as soon as SACK blocks show a segment lost (RFC 6675) */
+  void set_fast_retransmit( bool enabled ) { fast_retransmit_ = enabled; }
+
   /* Generate an empty TCPSenderMessage */
   TCPSenderMessage make_empty_message() const;
 
-  /* Receive and process a TCPReceiverMessage from the peer's receiver */
-  void receive( const TCPReceiverMessage& msg );
+  /* Receive and process a TCPReceiverMessage from the peer's receiver (`carries_data`: it came with a segment
+     of data, so repeating the last ackno doesn't make it a duplicate ack) */
+  void receive( const TCPReceiverMessage& msg, bool carries_data = false );
 
   /* Type of the `transmit` function that the push and tick methods can use to send messages */
   using TransmitFunction = std::function<void( const TCPSenderMessage& )>;
@@ -54,6 +102,13 @@ public:
   // Accessors
   uint64_t sequence_numbers_in_flight() const;  // How many sequence numbers are outstanding?
   uint64_t consecutive_retransmissions() const; // How many consecutive *re*transmissions have happened?
+  uint64_t RTO_ms() const { return timer_.RTO_ms(); }                  // Current retransmission timeout
+  std::optional<uint64_t> SRTT_ms() const { return timer_.SRTT_ms(); } // Smoothed RTT, once measured
+  std::optional<uint64_t> RTTVAR_ms() const { return timer_.RTTVAR_ms(); }
+  uint64_t mss() const;         // Largest payload per segment, as agreed with the peer
+  uint64_t cwnd() const;        // Congestion window
+  uint64_t pacing_rate() const; // Bytes per second transmissions are spread at (0 if not paced)
+  bool in_recovery() const { return recovery_point_.has_value(); } // Repairing losses?
   Writer& writer() { return input_.writer(); }
   const Writer& writer() const { return input_.writer(); }
 
@@ -64,15 +119,43 @@ private:
   // Variables initialized in constructor
   ByteStream input_;
   Wrap32 isn_;
-  uint64_t initial_RTO_ms_;
   RetransmissionsTimer timer_ {};
+  uint64_t now_ms_ {};
+  // the segment being timed for an RTT sample: its end (absolute seqno) and when it was sent
+  std::optional<std::pair<uint64_t, uint64_t>> timed_segment_ {};
+  uint64_t mss_ { TCPConfig::MAX_PAYLOAD_SIZE };
+  std::optional<uint64_t> peer_mss_ {}; // from the peer's SYN
+  uint64_t syn_option_bytes_ {};
+  uint64_t option_bytes_ {};
+  CongestionAlgorithm congestion_algorithm_ { CongestionAlgorithm::None };
+  AnyCongestionControl congestion_ { NoCongestionControl { 0 } };
+  bool pacing_ {};
+  uint64_t pacing_credit_ {}; // bytes the pacing rate allows to be sent now
   uint64_t receive_index_ {};
   uint64_t send_index_ {};
   // Before receive the windows size from receiver, we assume that it have space to receive SYN
   uint64_t window_size_ { 1 };
+  uint8_t window_shift_ {}; // peer's window scale (RFC 7323), from its SYN
   uint64_t retransmission_time_ {};
-  std::map<uint64_t, TCPSenderMessage> outstanding_seg_ {};
+  // segments sent but not fully acked, by absolute seqno; sent in order, so acks pop them from the front
+  std::deque<std::pair<uint64_t, TCPSenderMessage>> outstanding_seg_ {};
   bool is_initialized_ {};
   bool is_closed_ {};
-  void insert_buffer_( uint64_t index, TCPSenderMessage msg );
+  void insert_buffer_( uint64_t index, const TCPSenderMessage& msg );
+
+  // Loss recovery
+  static constexpr uint64_t DUP_THRESH = 3;
+  bool fast_retransmit_ {};
+  uint64_t dup_acks_ {};
+  std::optional<uint64_t> recovery_point_ {}; // send_index_ when recovery began; it ends once that is acked
+  uint64_t high_rxt_ {};                      // end of the highest segment resent in this recovery
+  bool fast_recovery_ {}; // this recovery began on duplicate acks or SACK (not an RTO), so cwnd holds through it
+  std::map<uint64_t, uint64_t> sacked_ {};    // the scoreboard: merged [begin, end) ranges the peer SACKed
+  bool record_sack_( const std::vector<TCPReceiverMessage::SACKBlock>& sack, uint64_t ackno );
+  bool is_sacked_( uint64_t begin, uint64_t end ) const;
+  template<typename F>
+  void scoreboard_( F&& on_segment ) const;
+  void detect_loss_();
+  uint64_t pipe_() const;
+  void retransmit_lost_( const TransmitFunction& transmit, uint64_t& pipe );
 };
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <span>
 
 /*
  * The Wrap32 type represents a 32-bit unsigned integer that:
@@ -11,22 +12,44 @@
 class Wrap32
 {
 public:
-  explicit Wrap32( uint32_t raw_value ) : raw_value_( raw_value ) {}
+  constexpr explicit Wrap32( uint32_t raw_value ) : raw_value_( raw_value ) {}
 
   /* Construct a Wrap32 given an absolute sequence number n and the zero point. */
-  static Wrap32 wrap( uint64_t n, Wrap32 zero_point );
+  static constexpr Wrap32 wrap( uint64_t n, Wrap32 zero_point )
+  {
+    return Wrap32 { zero_point.raw_value_ + static_cast<uint32_t>( n ) };
+  }
 
   /*
    * The unwrap method returns an absolute sequence number that wraps to this Wrap32, given the zero point
    * and a "checkpoint": another absolute sequence number near the desired answer.
    *
    * There are many possible absolute sequence numbers that all wrap to the same Wrap32.
-   * The unwrap method should return the one that is closest to the checkpoint.
+   * The unwrap method should return the one that is closest to the checkpoint
+   * (the larger one if two are equally close).
    */
-  uint64_t unwrap( Wrap32 zero_point, uint64_t checkpoint ) const;
+  constexpr uint64_t unwrap( Wrap32 zero_point, uint64_t checkpoint ) const
+  {
+    // distance forward from the checkpoint to the nearest candidate at or after it
+    const uint32_t offset = raw_value_ - wrap( checkpoint, zero_point ).raw_value_;
+    const uint64_t after = checkpoint + offset;
+    // step back one wrap when the candidate before the checkpoint is closer and isn't below zero
+    const bool back = offset > ( uint32_t { 1 } << 31 ) and after >= ( uint64_t { 1 } << 32 );
+    return after - ( static_cast<uint64_t>( back ) << 32 );
+  }
 
-  Wrap32 operator+( uint32_t n ) const { return Wrap32 { raw_value_ + n }; }
-  bool operator==( const Wrap32& other ) const { return raw_value_ == other.raw_value_; }
+  /*
+   * Unwrap every seqno in `seqnos` against the same zero point and checkpoint, writing the absolute sequence
+   * numbers to the front of `out` (which must be at least as long). Same result as calling unwrap() on each,
+   * but the loop has no branches, so the compiler can vectorize it for bursts of segments or acks.
+   */
+  static void unwrap( std::span<const Wrap32> seqnos,
+                      Wrap32 zero_point,
+                      uint64_t checkpoint,
+                      std::span<uint64_t> out );
+
+  constexpr Wrap32 operator+( uint32_t n ) const { return Wrap32 { raw_value_ + n }; }
+  constexpr bool operator==( const Wrap32& other ) const { return raw_value_ == other.raw_value_; }
 
 protected:
   uint32_t raw_value_ {};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <malloc.h>
+#include <new>
+
+/*
+ * Heap accounting for the speed tests, which report allocations and memory alongside time. This replaces the
+ * global operator new and delete, so include it from a speed test's own source file and nowhere else.
+ */
+
+namespace heap {
+inline uint64_t allocations = 0; // NOLINT(*-avoid-non-const-global-variables) calls to operator new
+inline uint64_t in_use = 0;      // NOLINT(*-avoid-non-const-global-variables) bytes malloc() has handed out
+inline uint64_t peak = 0;        // NOLINT(*-avoid-non-const-global-variables) highest in_use since last reset
+} // namespace heap
+
+// Results are stored here so the work that produced them isn't optimized out
+inline volatile uint64_t sink = 0; // NOLINT(*-avoid-non-const-global-variables)
+
+void* operator new( std::size_t size )
+{
+  if ( void* p = std::malloc( size ) ) { // NOLINT(*-no-malloc)
+    ++heap::allocations;
+    heap::in_use += malloc_usable_size( p );
+    heap::peak = std::max( heap::peak, heap::in_use );
+    return p;
+  }
+  throw std::bad_alloc {};
+}
+
+void operator delete( void* p ) noexcept
+{
+  heap::in_use -= malloc_usable_size( p );
+  std::free( p ); // NOLINT(*-no-malloc)
+}
+
+void operator delete( void* p, std::size_t /* size */ ) noexcept
+{
+  operator delete( p );
+}
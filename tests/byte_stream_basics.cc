@@ -48,6 +48,20 @@ int main()
       test.execute( Peek { "" } );
     }
 
+    for ( const auto storage :
+          { ByteStream::Storage::Contiguous,
+            ByteStream::Storage::Ring,
+            ByteStream::Storage::Chunked,
+            ByteStream::Storage::Mirrored,
+            ByteStream::Storage::Slab } ) {
+      ByteStreamTestHarness test { "peek-during-reserve", 15, storage };
+      test.execute( Push { "abc" } );
+      test.execute( Reserve { 5 } );
+      test.execute( BytesBuffered { 3 } );
+      test.execute( Peek { "abc" } );
+      test.execute( PeekAll { "abc" } );
+    }
+
   } catch ( const exception& e ) {
     cerr << "Exception: " << e.what() << "\n";
     return EXIT_FAILURE;
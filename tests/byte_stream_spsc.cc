@@ -0,0 +1,100 @@
+#include "spsc_byte_stream.hh"
+
+#include <iostream>
+#include <poll.h>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+// Block until `event` is signalled (or a short timeout passes, to guard against a lost wakeup hanging the test)
+void wait_for( FileDescriptor& event )
+{
+  pollfd pfd { event.fd_num(), POLLIN, 0 };
+  ::poll( &pfd, 1, 1000 );
+}
+
+void spsc_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-parameters)
+                const size_t capacity,    // NOLINT(bugprone-easily-swappable-parameters)
+                const size_t random_seed, // NOLINT(bugprone-easily-swappable-parameters)
+                const bool with_events )
+{
+  const string data = [&] {
+    default_random_engine rd { random_seed };
+    uniform_int_distribution<char> ud;
+    string ret;
+    for ( size_t i = 0; i < input_len; ++i ) {
+      ret += ud( rd );
+    }
+    return ret;
+  }();
+
+  SPSCByteStream bs { capacity, with_events };
+
+  thread producer( [&] {
+    default_random_engine rd { random_seed + 1 };
+    uniform_int_distribution<size_t> write_size { 1, capacity * 2 };
+    size_t offset = 0;
+    while ( offset < data.size() ) {
+      if ( with_events ) {
+        SPSCByteStream::clear_event( bs.writable_event() );
+      }
+      const size_t pushed = bs.push( string_view( data ).substr( offset, write_size( rd ) ) );
+      offset += pushed;
+      if ( pushed == 0 and with_events ) {
+        wait_for( bs.writable_event() );
+      }
+    }
+    bs.close();
+  } );
+
+  string output;
+  default_random_engine rd { random_seed + 2 };
+  uniform_int_distribution<size_t> read_size { 1, capacity };
+  while ( not bs.is_finished() ) {
+    if ( with_events ) {
+      SPSCByteStream::clear_event( bs.readable_event() );
+    }
+    const auto view = bs.peek().substr( 0, read_size( rd ) );
+    if ( view.empty() ) {
+      if ( with_events and not bs.is_closed() ) {
+        wait_for( bs.readable_event() );
+      }
+      continue;
+    }
+    output += view;
+    bs.pop( view.size() );
+  }
+
+  producer.join();
+
+  if ( output != data ) {
+    throw runtime_error( "Mismatch between data written and read across threads" );
+  }
+  if ( bs.bytes_pushed() != input_len or bs.bytes_popped() != input_len ) {
+    throw runtime_error( "SPSCByteStream counters disagree with the data transferred" );
+  }
+}
+
+void program_body()
+{
+  for ( const bool with_events : { false, true } ) {
+    spsc_test( 1, 1, 1237, with_events );
+    spsc_test( 1000, 7, 4567, with_events );
+    spsc_test( 100000, 4096, 8910, with_events );
+  }
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,61 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      ByteStreamTestHarness test { "stats-disabled", 4 };
+
+      test.execute( Push { "hello" } );
+      test.execute( Pop { 2 } );
+      test.execute( HighWaterMark { 0 } );
+      test.execute( WriterFullStalls { 0 } );
+      test.execute( BytesCopied { 0 } );
+    }
+
+    {
+      ByteStreamTestHarness test { "stats-high-water-and-stalls", 4, ByteStream::Storage::Ring };
+
+      test.execute( EnableStats {} );
+      test.execute( Push { "ab" } );
+      test.execute( HighWaterMark { 2 } );
+      test.execute( WriterFullStalls { 0 } );
+      test.execute( Push { "cde" } );
+      test.execute( HighWaterMark { 4 } );
+      test.execute( WriterFullStalls { 1 } );
+      test.execute( Push { "f" } );
+      test.execute( WriterFullStalls { 2 } );
+      test.execute( Pop { 3 } );
+      test.execute( Push { "g" } );
+      test.execute( HighWaterMark { 4 } );
+      test.execute( WriterFullStalls { 2 } );
+      test.execute( BytesCopied { 5 } );
+      test.execute( ReadAll { "dg" } );
+      test.execute( ReaderEmptyPolls { 0 } );
+    }
+
+    {
+      ByteStreamTestHarness test { "stats-empty-polls", 4, ByteStream::Storage::Chunked };
+
+      test.execute( EnableStats {} );
+      test.execute( PeekOnce { "" } );
+      test.execute( PeekAll { "" } );
+      test.execute( ReaderEmptyPolls { 2 } );
+      test.execute( Push { "xyz" } );
+      test.execute( PeekOnce { "xyz" } );
+      test.execute( ReaderEmptyPolls { 2 } );
+      test.execute( BytesCopied { 0 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
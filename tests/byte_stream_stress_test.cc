@@ -5,9 +5,10 @@
 
 using namespace std;
 
-void stress_test( const size_t input_len,    // NOLINT(bugprone-easily-swappable-parameters)
-                  const size_t capacity,     // NOLINT(bugprone-easily-swappable-parameters)
-                  const size_t random_seed ) // NOLINT(bugprone-easily-swappable-parameters)
+void stress_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-parameters)
+                  const size_t capacity,    // NOLINT(bugprone-easily-swappable-parameters)
+                  const size_t random_seed, // NOLINT(bugprone-easily-swappable-parameters)
+                  const ByteStream::Storage storage )
 {
   default_random_engine rd { random_seed };
 
@@ -21,7 +22,8 @@ void stress_test( const size_t input_len,    // NOLINT(bugprone-easily-swappable
   }();
 
   ByteStreamTestHarness bs { "stress test input=" + to_string( input_len ) + ", capacity=" + to_string( capacity ),
-                             capacity };
+                             capacity,
+                             storage };
 
   size_t expected_bytes_pushed {};
   size_t expected_bytes_popped {};
@@ -35,7 +37,11 @@ void stress_test( const size_t input_len,    // NOLINT(bugprone-easily-swappable
     /* write something */
     uniform_int_distribution<size_t> bytes_to_push_dist { 0, data.size() - expected_bytes_pushed };
     const size_t amount_to_push = bytes_to_push_dist( rd );
-    bs.execute( Push { data.substr( expected_bytes_pushed, amount_to_push ) } );
+    if ( expected_bytes_pushed % 2 ) {
+      bs.execute( ReserveCommit { data.substr( expected_bytes_pushed, amount_to_push ) } );
+    } else {
+      bs.execute( Push { data.substr( expected_bytes_pushed, amount_to_push ) } );
+    }
     expected_bytes_pushed += min( amount_to_push, expected_available_capacity );
     expected_available_capacity -= min( amount_to_push, expected_available_capacity );
 
@@ -56,6 +62,7 @@ void stress_test( const size_t input_len,    // NOLINT(bugprone-easily-swappable
     }
 
     bs.execute( PeekOnce { data.substr( expected_bytes_popped, peek_size ) } );
+    bs.execute( PeekAll { data.substr( expected_bytes_popped, expected_bytes_pushed - expected_bytes_popped ) } );
 
     uniform_int_distribution<size_t> bytes_to_pop_dist { 0, peek_size };
     const size_t amount_to_pop = bytes_to_pop_dist( rd );
@@ -72,10 +79,18 @@ void stress_test( const size_t input_len,    // NOLINT(bugprone-easily-swappable
 
 void program_body()
 {
-  stress_test( 19, 3, 10110 );
-  stress_test( 18, 17, 12345 );
-  stress_test( 1111, 17, 98765 );
-  stress_test( 4097, 4096, 11101 );
+  for ( const auto storage :
+        { ByteStream::Storage::Contiguous,
+          ByteStream::Storage::Ring,
+          ByteStream::Storage::Chunked,
+          ByteStream::Storage::Mirrored,
+          ByteStream::Storage::Slab } ) {
+    stress_test( 19, 3, 10110, storage );
+    stress_test( 18, 17, 12345, storage );
+    stress_test( 1111, 17, 98765, storage );
+    stress_test( 4097, 4096, 11101, storage );
+    stress_test( 100000, 40000, 24680, storage ); // several 16 KB slabs
+  }
 }
 
 int main()
@@ -0,0 +1,130 @@
+#include "alloc_counter.hh"
+#include "byte_stream.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <span>
+#include <string>
+
+using namespace std;
+using namespace std::chrono;
+
+/*
+ * Sweep ByteStream throughput over storage backend x capacity x write size x read size, and print one
+ * machine-readable record per configuration (CSV by default, JSON lines with --json).
+ *
+ * Each configuration pushes copies of a write_size chunk whenever it fits and peeks/pops read_size bytes per
+ * iteration, for a fixed byte budget or time budget, whichever runs out first (so the slow corners of the
+ * sweep don't dominate the run time).
+ *
+ *   gbit_per_s     bytes moved through the stream
+ *   ns_per_op      wall time per push() or pop() call
+ *   allocs_per_mb  heap allocations per MB moved, including the caller's std::string for each push()
+ */
+
+struct Result
+{
+  string storage;
+  uint64_t capacity, write_size, read_size;
+  uint64_t bytes, ops, allocs;
+  double seconds;
+};
+
+Result run( ByteStream::Storage storage, uint64_t capacity, uint64_t write_size, uint64_t read_size )
+{
+  constexpr uint64_t byte_budget = 1 << 24;
+  constexpr auto time_budget = milliseconds( 20 );
+
+  const string chunk( write_size, 'x' );
+  ByteStream bs { capacity, storage };
+  uint64_t ops = 0;
+  uint64_t checksum = 0;
+
+  const auto start_allocations = heap::allocations;
+  const auto start_time = steady_clock::now();
+  auto now = start_time;
+  while ( bs.reader().bytes_popped() < byte_budget and now - start_time < time_budget ) {
+    for ( int i = 0; i < 256; ++i ) {
+      if ( bs.writer().available_capacity() >= write_size ) {
+        bs.writer().push( chunk );
+        ++ops;
+      }
+      const auto peeked = bs.reader().peek().substr( 0, read_size );
+      if ( not peeked.empty() ) {
+        checksum += static_cast<unsigned char>( peeked.front() );
+        bs.reader().pop( peeked.size() );
+        ++ops;
+      }
+    }
+    now = steady_clock::now();
+  }
+
+  sink = checksum;
+
+  return { storage_name( storage ),
+           capacity,
+           write_size,
+           read_size,
+           bs.reader().bytes_popped(),
+           ops,
+           heap::allocations - start_allocations,
+           duration_cast<duration<double>>( now - start_time ).count() };
+}
+
+void print( const Result& r, bool json )
+{
+  const double gbit_per_s = 8 * static_cast<double>( r.bytes ) / r.seconds / 1e9;
+  const double ns_per_op = r.seconds * 1e9 / static_cast<double>( max( r.ops, uint64_t { 1 } ) );
+  const double allocs_per_mb = static_cast<double>( r.allocs ) / ( static_cast<double>( r.bytes ) / 1e6 );
+
+  cout << fixed << setprecision( 3 );
+  if ( json ) {
+    cout << R"({"storage":")" << r.storage << R"(","capacity":)" << r.capacity << R"(,"write_size":)"
+         << r.write_size << R"(,"read_size":)" << r.read_size << R"(,"bytes":)" << r.bytes << R"(,"gbit_per_s":)"
+         << gbit_per_s << R"(,"ns_per_op":)" << ns_per_op << R"(,"allocs_per_mb":)" << allocs_per_mb << "}\n";
+  } else {
+    cout << r.storage << "," << r.capacity << "," << r.write_size << "," << r.read_size << "," << r.bytes << ","
+         << gbit_per_s << "," << ns_per_op << "," << allocs_per_mb << "\n";
+  }
+}
+
+void program_body( bool json )
+{
+  if ( not json ) {
+    cout << "storage,capacity,write_size,read_size,bytes,gbit_per_s,ns_per_op,allocs_per_mb\n";
+  }
+
+  for ( const auto storage : { ByteStream::Storage::Contiguous,
+                               ByteStream::Storage::Ring,
+                               ByteStream::Storage::Chunked,
+                               ByteStream::Storage::Mirrored,
+                               ByteStream::Storage::Slab } ) {
+    for ( const uint64_t capacity : { 4096, 65536, 1048576 } ) {
+      for ( const uint64_t write_size : { 64, 1500, 4096 } ) {
+        for ( const uint64_t read_size : { 16, 1500, 65536 } ) {
+          const auto result = run( storage, capacity, write_size, read_size );
+          if ( result.bytes == 0 ) {
+            throw runtime_error( "ByteStream moved no bytes with storage " + result.storage );
+          }
+          print( result, json );
+        }
+      }
+    }
+  }
+}
+
+int main( int argc, char* argv[] )
+{
+  try {
+    const span<char*> args( argv, argc );
+    program_body( args.size() > 1 and strcmp( args[1], "--json" ) == 0 );
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -3,6 +3,7 @@
 #include "byte_stream.hh"
 #include "common.hh"
 
+#include <algorithm>
 #include <concepts>
 #include <optional>
 #include <utility>
@@ -16,8 +17,10 @@ static_assert( sizeof( Writer ) == sizeof( ByteStream ),
 class ByteStreamTestHarness : public TestHarness<ByteStream>
 {
 public:
-  ByteStreamTestHarness( std::string test_name, uint64_t capacity )
-    : TestHarness( move( test_name ), "capacity=" + std::to_string( capacity ), ByteStream { capacity } )
+  ByteStreamTestHarness( std::string test_name,
+                         uint64_t capacity,
+                         ByteStream::Storage storage = ByteStream::Storage::Contiguous )
+    : TestHarness( move( test_name ), "capacity=" + std::to_string( capacity ), ByteStream { capacity, storage } )
   {}
 
   size_t peek_size() { return object().reader().peek().size(); }
@@ -34,6 +37,35 @@ struct Push : public Action<ByteStream>
   void execute( ByteStream& bs ) const override { bs.writer().push( data_ ); }
 };
 
+struct ReserveCommit : public Action<ByteStream>
+{
+  std::string data_;
+
+  explicit ReserveCommit( std::string data ) : data_( move( data ) ) {}
+  std::string description() const override
+  {
+    return "reserve and commit \"" + Printer::prettify( data_ ) + "\" to the stream";
+  }
+  void execute( ByteStream& bs ) const override
+  {
+    uint64_t written = 0;
+    for ( const auto region : bs.writer().reserve( data_.size() ) ) {
+      std::copy_n( data_.data() + written, region.size(), region.data() );
+      written += region.size();
+    }
+    bs.writer().commit( written );
+  }
+};
+
+struct Reserve : public Action<ByteStream>
+{
+  uint64_t len_;
+
+  explicit Reserve( uint64_t len ) : len_( len ) {}
+  std::string description() const override { return "reserve " + std::to_string( len_ ) + " bytes"; }
+  void execute( ByteStream& bs ) const override { bs.writer().reserve( len_ ); }
+};
+
 struct Close : public Action<ByteStream>
 {
   std::string description() const override { return "close"; }
@@ -46,6 +78,12 @@ struct SetError : public Action<ByteStream>
   void execute( ByteStream& bs ) const override { bs.set_error(); }
 };
 
+struct EnableStats : public Action<ByteStream>
+{
+  std::string description() const override { return "enable_stats"; }
+  void execute( ByteStream& bs ) const override { bs.enable_stats(); }
+};
+
 struct Pop : public Action<ByteStream>
 {
   size_t len_;
@@ -107,6 +145,31 @@ struct PeekOnce : public Peek
   }
 };
 
+struct PeekAll : public Peek
+{
+  using Peek::Peek;
+
+  std::string description() const override
+  {
+    return "peek_all() gives \"" + Printer::prettify( output_ ) + "\"";
+  }
+
+  void execute( ByteStream& bs ) const override
+  {
+    std::string got;
+    for ( const auto view : bs.reader().peek_all() ) {
+      if ( view.empty() ) {
+        throw ExpectationViolation { "Reader::peek_all() returned an empty string_view" };
+      }
+      got += view;
+    }
+    if ( got != output_ ) {
+      throw ExpectationViolation { "Expected \"" + Printer::prettify( output_ ) + "\" in buffer, but found \""
+                                   + Printer::prettify( got ) + "\"" };
+    }
+  }
+};
+
 struct IsClosed : public ConstExpectBool<ByteStream>
 {
   using ConstExpectBool::ConstExpectBool;
@@ -163,6 +226,34 @@ struct BytesPopped : public ExpectNumber<ByteStream, uint64_t>
   size_t value( ByteStream& bs ) const override { return bs.reader().bytes_popped(); }
 };
 
+struct HighWaterMark : public ConstExpectNumber<ByteStream, uint64_t>
+{
+  using ConstExpectNumber::ConstExpectNumber;
+  std::string name() const override { return "stats().high_water_mark"; }
+  size_t value( const ByteStream& bs ) const override { return bs.stats().high_water_mark; }
+};
+
+struct WriterFullStalls : public ConstExpectNumber<ByteStream, uint64_t>
+{
+  using ConstExpectNumber::ConstExpectNumber;
+  std::string name() const override { return "stats().writer_full_stalls"; }
+  size_t value( const ByteStream& bs ) const override { return bs.stats().writer_full_stalls; }
+};
+
+struct ReaderEmptyPolls : public ConstExpectNumber<ByteStream, uint64_t>
+{
+  using ConstExpectNumber::ConstExpectNumber;
+  std::string name() const override { return "stats().reader_empty_polls"; }
+  size_t value( const ByteStream& bs ) const override { return bs.stats().reader_empty_polls; }
+};
+
+struct BytesCopied : public ConstExpectNumber<ByteStream, uint64_t>
+{
+  using ConstExpectNumber::ConstExpectNumber;
+  std::string name() const override { return "stats().bytes_copied"; }
+  size_t value( const ByteStream& bs ) const override { return bs.stats().bytes_copied; }
+};
+
 struct ReadAll : public Expectation<ByteStream>
 {
   std::string output_;
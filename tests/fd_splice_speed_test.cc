@@ -0,0 +1,135 @@
+#include "byte_stream.hh"
+#include "exception.hh"
+#include "file_descriptor.hh"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+using namespace std;
+using namespace std::chrono;
+
+static constexpr size_t pipe_size = 1048576;
+
+pair<FileDescriptor, FileDescriptor> make_pipe()
+{
+  array<int, 2> fds {};
+  CheckSystemCall( "pipe2", ::pipe2( fds.data(), O_CLOEXEC ) );
+  // a full-size pipe where the kernel allows it, so both paths move the same amount per syscall
+  ::fcntl( fds[1], F_SETPIPE_SZ, pipe_size ); // NOLINT(*-vararg)
+  return { FileDescriptor { fds[0] }, FileDescriptor { fds[1] } };
+}
+
+// Copy everything from `in` to `out` the way bidirectional_stream_copy does: into a ByteStream and back out
+void copy_through_bytestream( FileDescriptor& in, FileDescriptor& out )
+{
+  ByteStream bs { pipe_size, ByteStream::Storage::Mirrored };
+  while ( not bs.reader().is_finished() ) {
+    if ( not bs.writer().is_closed() ) {
+      Writer& writer = bs.writer();
+      writer.commit( in.read( writer.reserve( writer.available_capacity() ) ) );
+      if ( in.eof() ) {
+        writer.close();
+      }
+    }
+    if ( bs.reader().bytes_buffered() ) {
+      bs.reader().pop( out.write( bs.reader().peek_all() ) );
+    }
+  }
+}
+
+// Copy everything from `in` to `out` inside the kernel
+void copy_with_splice( FileDescriptor& in, FileDescriptor& out )
+{
+  while ( not in.eof() ) {
+    if ( not in.splice_to( out, pipe_size ).has_value() ) {
+      throw runtime_error( "splice between pipes unexpectedly unsupported" );
+    }
+  }
+}
+
+void speed_test( const size_t input_len, // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t write_size,
+                 const bool use_splice )
+{
+  auto [source_read, source_write] = make_pipe();
+  auto [sink_read, sink_write] = make_pipe();
+
+  thread producer( [&, &source_write = source_write] {
+    const string chunk( write_size, 'x' );
+    for ( size_t sent = 0; sent < input_len; sent += chunk.size() ) {
+      for ( size_t written = 0; written < chunk.size(); ) {
+        written += source_write.write( string_view( chunk ).substr( written ) );
+      }
+    }
+    source_write.close();
+  } );
+
+  size_t received = 0;
+  thread consumer( [&, &sink_read = sink_read] {
+    string buffer;
+    while ( not sink_read.eof() ) {
+      buffer.resize( pipe_size );
+      sink_read.read( buffer );
+      received += buffer.size();
+    }
+  } );
+
+  const auto start_time = steady_clock::now();
+  if ( use_splice ) {
+    copy_with_splice( source_read, sink_write );
+  } else {
+    copy_through_bytestream( source_read, sink_write );
+  }
+  sink_write.close();
+  consumer.join();
+  const auto stop_time = steady_clock::now();
+  producer.join();
+
+  if ( received != input_len ) {
+    throw runtime_error( "Mismatch between bytes written and read" );
+  }
+
+  auto test_duration = duration_cast<duration<double>>( stop_time - start_time );
+  auto gigabits_per_second = 8 * static_cast<double>( input_len ) / test_duration.count() / 1e9;
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  const string path = use_splice ? "splice" : "ByteStream";
+  cout << "pipe-to-pipe copy via " << path << " with write_size=" << write_size << " reached " << fixed
+       << setprecision( 2 ) << gigabits_per_second << " Gbit/s.\n";
+
+  debug_output << "             pipe copy (" << setw( 10 ) << path << ") throughput: " << fixed << setprecision( 2 )
+               << gigabits_per_second << " Gbit/s\n";
+
+  if ( gigabits_per_second < 0.1 ) {
+    throw runtime_error( "pipe copy did not meet minimum speed of 0.1 Gbit/s." );
+  }
+}
+
+void program_body()
+{
+  for ( const bool use_splice : { false, true } ) {
+    speed_test( 1 << 28, 65536, use_splice );
+  }
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
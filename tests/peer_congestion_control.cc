@@ -0,0 +1,232 @@
+#include "fd_adapter.hh"
+#include "lossy_fd_adapter.hh"
+#include "peer_test_harness.hh"
+#include "tcp_config.hh"
+#include "tcp_peer.hh"
+
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+using namespace std;
+
+/*
+ * Send a stream between two TCPPeers over a simulated path whose forward direction is a bottleneck: a
+ * drop-tail queue served at a fixed rate, then a propagation delay. Each end of the path is wrapped in a
+ * LossyFdAdapter, which can add random loss on top. The simulation runs on a virtual 1 ms clock.
+ */
+
+// One direction of the path
+class Link
+{
+public:
+  Link( uint64_t rate, uint64_t queue_limit, uint64_t delay ) // NOLINT(*-swappable-*)
+    : rate_( rate ), queue_limit_( queue_limit ), delay_( delay )
+  {}
+
+  void send( const TCPMessage& msg )
+  {
+    const auto size = msg.sender.payload.size() + 40; // with IP and TCP headers
+    if ( queued_ + size > queue_limit_ ) {
+      ++drops_;
+      return;
+    }
+    queued_ += size;
+    queue_.emplace_back( msg, size );
+  }
+
+  // Serve the queue for one more millisecond, and let through what has finished propagating
+  void advance( uint64_t now )
+  {
+    credit_ = queue_.empty() ? 0 : credit_ + rate_;
+    while ( not queue_.empty() and queue_.front().second <= credit_ ) {
+      credit_ -= queue_.front().second;
+      queued_ -= queue_.front().second;
+      propagating_.emplace_back( now + delay_, move( queue_.front().first ) );
+      queue_.pop_front();
+    }
+    while ( not propagating_.empty() and propagating_.front().first <= now ) {
+      arrived_.push_back( move( propagating_.front().second ) );
+      propagating_.pop_front();
+    }
+  }
+
+  bool has_arrivals() const { return not arrived_.empty(); }
+
+  optional<TCPMessage> receive()
+  {
+    if ( arrived_.empty() ) {
+      return {};
+    }
+    auto msg = move( arrived_.front() );
+    arrived_.pop_front();
+    return msg;
+  }
+
+  uint64_t drops() const { return drops_; }
+
+private:
+  uint64_t rate_;        // bytes per ms
+  uint64_t queue_limit_; // bytes
+  uint64_t delay_;       // ms
+  uint64_t queued_ {};
+  uint64_t credit_ {};
+  uint64_t drops_ {};
+  deque<pair<TCPMessage, uint64_t>> queue_ {};
+  deque<pair<uint64_t, TCPMessage>> propagating_ {};
+  deque<TCPMessage> arrived_ {};
+};
+
+struct Path
+{
+  Link forward;
+  Link reverse;
+};
+
+// One end of the path, as the datagram adapter underneath a LossyFdAdapter
+class PathEnd : public FdAdapterBase
+{
+public:
+  PathEnd( shared_ptr<Path> path, bool sender, uint16_t loss_rate )
+    : path_( move( path ) ), sender_( sender )
+  {
+    config_mut().loss_rate_up = loss_rate;
+  }
+
+  optional<TCPMessage> read() { return in().receive(); }
+  void write( const TCPMessage& msg ) { out().send( msg ); }
+
+private:
+  shared_ptr<Path> path_;
+  bool sender_;
+
+  Link& in() const { return sender_ ? path_->reverse : path_->forward; }
+  Link& out() const { return sender_ ? path_->forward : path_->reverse; }
+};
+
+struct Result
+{
+  uint64_t duration_ms;
+  uint64_t queue_drops;
+};
+
+Result transfer( const TCPConfig& cfg, uint16_t loss_rate, const string& data )
+{
+  auto path = make_shared<Path>( Path { Link { 1000, 20 * 1040, 10 }, Link { 100'000, 1 << 20, 10 } } );
+  LossyFdAdapter<PathEnd> sender_end { PathEnd { path, true, loss_rate } };
+  LossyFdAdapter<PathEnd> receiver_end { PathEnd { path, false, 0 } };
+
+  TCPConfig sender_cfg = cfg;
+  sender_cfg.send_capacity = data.size();
+  TCPPeer sender { sender_cfg };
+  TCPPeer receiver { cfg };
+  // new data may only go out while the bytes in flight fit in the congestion window (outside loss recovery,
+  // where segments known to have left the network don't count)
+  uint64_t last_in_flight = 0;
+  const auto to_receiver = [&]( const TCPMessage& msg ) {
+    const auto in_flight = sender.sender().sequence_numbers_in_flight();
+    if ( in_flight > last_in_flight and in_flight > sender.sender().cwnd() and not sender.sender().in_recovery() ) {
+      throw runtime_error( "sender has more in flight than its congestion window" );
+    }
+    last_in_flight = in_flight;
+    sender_end.write( msg );
+  };
+  const auto to_sender = [&]( const TCPMessage& msg ) { receiver_end.write( msg ); };
+
+  sender.outbound_writer().push( data );
+  sender.outbound_writer().close();
+  sender.push( to_receiver );
+
+  string received;
+  constexpr uint64_t time_limit_ms = 120'000;
+  uint64_t now = 0;
+  for ( ; now < time_limit_ms and not receiver.inbound_reader().is_finished(); ++now ) {
+    path->forward.advance( now );
+    path->reverse.advance( now );
+    while ( path->forward.has_arrivals() ) {
+      if ( auto msg = receiver_end.read() ) {
+        receiver.receive( move( *msg ), to_sender );
+      }
+    }
+    while ( path->reverse.has_arrivals() ) {
+      if ( auto msg = sender_end.read() ) {
+        sender.receive( move( *msg ), to_receiver );
+      }
+    }
+
+    drain( receiver, received );
+
+    sender.tick( 1, to_receiver );
+    receiver.tick( 1, to_sender );
+    last_in_flight = sender.sender().sequence_numbers_in_flight();
+  }
+
+  if ( received != data ) {
+    throw runtime_error( "stream did not arrive intact within " + to_string( time_limit_ms ) + " ms" );
+  }
+  return { now, path->forward.drops() };
+}
+
+void program_body()
+{
+  default_random_engine rd { 1357 };
+  string data( 1 << 20, 0 );
+  generate( data.begin(), data.end(), [&] { return rd(); } );
+
+  TCPConfig uncontrolled;
+  uncontrolled.congestion_control = CongestionAlgorithm::None;
+  const auto baseline = transfer( uncontrolled, 0, data );
+  if ( baseline.queue_drops == 0 ) {
+    throw runtime_error( "without congestion control, the bottleneck queue should overflow" );
+  }
+
+  for ( const auto algorithm : { CongestionAlgorithm::NewReno, CongestionAlgorithm::Cubic } ) {
+    const auto* name = algorithm == CongestionAlgorithm::NewReno ? "NewReno" : "Cubic";
+    for ( const bool pacing : { false, true } ) {
+      TCPConfig cfg;
+      cfg.congestion_control = algorithm;
+      cfg.pacing = pacing;
+      const auto result = transfer( cfg, 0, data );
+      if ( result.queue_drops * 4 > baseline.queue_drops ) {
+        throw runtime_error( string( name ) + ( pacing ? " (paced)" : "" ) + " lost "
+                             + to_string( result.queue_drops ) + " segments at the bottleneck, vs. "
+                             + to_string( baseline.queue_drops ) + " without congestion control" );
+      }
+      if ( result.duration_ms > baseline.duration_ms ) {
+        throw runtime_error( string( name ) + ( pacing ? " (paced)" : "" ) + " took "
+                             + to_string( result.duration_ms ) + " ms, vs. " + to_string( baseline.duration_ms )
+                             + " ms without congestion control" );
+      }
+    }
+
+    // random loss on top of the bottleneck (about 1%), repaired by fast retransmit or only by the RTO
+    TCPConfig cfg;
+    cfg.congestion_control = algorithm;
+    const auto recovered = transfer( cfg, 655, data );
+    cfg.fast_retransmit = false;
+    const auto timed_out = transfer( cfg, 655, data );
+    if ( recovered.duration_ms >= timed_out.duration_ms ) {
+      throw runtime_error( string( name ) + " with fast retransmit took " + to_string( recovered.duration_ms )
+                           + " ms, vs. " + to_string( timed_out.duration_ms ) + " ms waiting for the RTO" );
+    }
+  }
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
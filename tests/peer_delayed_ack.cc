@@ -0,0 +1,106 @@
+#include "peer_test_harness.hh"
+#include "tcp_config.hh"
+#include "tcp_peer.hh"
+
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+// Two TCPPeers joined back to back, delivering each peer's segments to the other only when asked
+struct Link
+{
+  TCPPeer a;
+  TCPPeer b;
+  deque<TCPMessage> to_a {};
+  deque<TCPMessage> to_b {};
+
+  TCPPeer::TransmitFunction from_a() { return [&]( TCPMessage msg ) { to_b.push_back( move( msg ) ); }; }
+  TCPPeer::TransmitFunction from_b() { return [&]( TCPMessage msg ) { to_a.push_back( move( msg ) ); }; }
+
+  void deliver_to_a() { deliver( to_a, a, from_a() ); }
+  void deliver_to_b() { deliver( to_b, b, from_b() ); }
+
+  void connect()
+  {
+    a.push( from_a() );
+    deliver_to_b();
+    deliver_to_a();
+    deliver_to_b();
+    if ( not to_a.empty() or not to_b.empty() ) {
+      throw runtime_error( "handshake did not settle" );
+    }
+  }
+
+  // Have `a` send `data`, and return the segments it sent without delivering them
+  deque<TCPMessage> send_from_a( const string& data )
+  {
+    a.outbound_writer().push( data );
+    a.push( from_a() );
+    return exchange( to_b, {} );
+  }
+
+  // Deliver `segments` to `b` one at a time, and return how many ACKs it sent
+  size_t acks_for( deque<TCPMessage> segments )
+  {
+    for ( auto& msg : segments ) {
+      b.receive( move( msg ), from_b() );
+    }
+    return exchange( to_a, {} ).size();
+  }
+};
+
+void program_body()
+{
+  const string full( TCPConfig::MAX_PAYLOAD_SIZE, 'x' );
+
+  {
+    Link link { TCPPeer { TCPConfig {} }, TCPPeer { TCPConfig {} } };
+    link.connect();
+    expect( link.acks_for( link.send_from_a( full + full + full + full ) ), 2, "ACKs for four full segments" );
+    expect( link.acks_for( link.send_from_a( full ) ), 0, "ACKs for a fifth full segment" );
+    link.b.tick( TCPConfig {}.delayed_ack_ms - 1, link.from_b() );
+    expect( link.to_a.size(), 0, "ACKs just before the delayed-ACK timer runs out" );
+    link.b.tick( 1, link.from_b() );
+    expect( link.to_a.size(), 1, "ACKs once the delayed-ACK timer runs out" );
+    link.deliver_to_a();
+    expect( link.a.sender().sequence_numbers_in_flight(), 0, "seqnos in flight after the delayed ACK" );
+  }
+
+  {
+    Link link { TCPPeer { TCPConfig {} }, TCPPeer { TCPConfig {} } };
+    link.connect();
+    auto segments = link.send_from_a( full + full + full );
+    swap( segments[0], segments[2] );
+    expect( link.acks_for( { segments[0] } ), 1, "ACKs for out-of-order data" );
+    expect( link.acks_for( { segments[1] } ), 1, "ACKs for more out-of-order data" );
+    expect( link.acks_for( { segments[2] } ), 1, "ACKs for data filling the gap" );
+    expect( link.acks_for( link.send_from_a( "abc" ) ), 0, "ACKs for a small in-order segment" );
+    link.a.outbound_writer().close();
+    link.a.push( link.from_a() );
+    expect( link.acks_for( exchange( link.to_b, {} ) ), 1, "ACKs for a FIN" );
+  }
+
+  {
+    TCPConfig cfg;
+    cfg.delayed_ack_ms = 0;
+    Link link { TCPPeer { cfg }, TCPPeer { cfg } };
+    link.connect();
+    expect( link.acks_for( link.send_from_a( full + full + full + full ) ), 4, "ACKs without delayed ACKs" );
+  }
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,183 @@
+#include "parser.hh"
+#include "peer_test_harness.hh"
+#include "tcp_config.hh"
+#include "tcp_peer.hh"
+#include "tcp_segment.hh"
+
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+struct Result
+{
+  uint64_t mss;             // as agreed by the sender
+  size_t largest_payload;   // of the segments it sent
+  size_t segments_with_data;
+};
+
+// Send `data` from a peer with MSS `mss_a` to one with MSS `mss_b`
+Result transfer( uint16_t mss_a, uint16_t mss_b, const string& data )
+{
+  TCPConfig cfg_a;
+  cfg_a.mss = mss_a;
+  TCPConfig cfg_b;
+  cfg_b.mss = mss_b;
+  TCPPeer a { cfg_a };
+  TCPPeer b { cfg_b };
+
+  Result result {};
+  deque<TCPMessage> to_a;
+  deque<TCPMessage> to_b;
+  const auto from_a = [&]( const TCPMessage& msg ) {
+    if ( not msg.sender.payload.empty() ) {
+      result.largest_payload = max( result.largest_payload, msg.sender.payload.size() );
+      ++result.segments_with_data;
+    }
+    to_b.push_back( over_the_wire( msg ) );
+  };
+  const auto from_b = [&]( const TCPMessage& msg ) { to_a.push_back( over_the_wire( msg ) ); };
+
+  a.outbound_writer().push( data );
+  a.outbound_writer().close();
+  a.push( from_a );
+
+  string received;
+  for ( int ms = 0; ms < 10'000 and received.size() < data.size(); ++ms ) {
+    while ( not to_b.empty() or not to_a.empty() ) {
+      deliver( to_b, b, from_b );
+      deliver( to_a, a, from_a );
+    }
+    drain( b, received );
+    a.tick( 1, from_a );
+    b.tick( 1, from_b );
+  }
+
+  if ( received != data ) {
+    throw runtime_error( "stream did not arrive intact" );
+  }
+  result.mss = a.sender().mss();
+  return result;
+}
+
+// Send `data` both ways between peers with MSS `mss`, losing every seventh segment with data, and return how
+// many segments carried both data and SACK blocks; every segment's payload and options must fit in the MSS
+size_t lossy_exchange( uint16_t mss, const string& data )
+{
+  TCPConfig cfg;
+  cfg.mss = mss;
+  TCPPeer a { cfg };
+  TCPPeer b { cfg };
+
+  size_t with_sack {};
+  size_t data_segments {};
+  deque<TCPMessage> to_a;
+  deque<TCPMessage> to_b;
+  const auto carry = [&]( const TCPMessage& msg, deque<TCPMessage>& queue ) {
+    TCPSegment seg { msg, { 1234, 5678, 0 } };
+    size_t tcp_length {};
+    for ( const auto& piece : serialize( seg ) ) {
+      tcp_length += piece.size();
+    }
+    if ( tcp_length > 20UL + mss ) {
+      throw runtime_error( "segment of " + to_string( tcp_length ) + " bytes overruns the MSS" );
+    }
+    if ( msg.sender.payload.empty() ) {
+      queue.push_back( over_the_wire( msg ) );
+      return;
+    }
+    with_sack += msg.receiver.sack.empty() ? 0 : 1;
+    if ( ++data_segments % 7 ) {
+      queue.push_back( over_the_wire( msg ) );
+    }
+  };
+  const auto from_a = [&]( const TCPMessage& msg ) { carry( msg, to_b ); };
+  const auto from_b = [&]( const TCPMessage& msg ) { carry( msg, to_a ); };
+
+  a.outbound_writer().push( data );
+  a.outbound_writer().close();
+  b.outbound_writer().push( data );
+  b.outbound_writer().close();
+  a.push( from_a );
+
+  string received_a;
+  string received_b;
+  const auto done = [&] { return received_a.size() == data.size() and received_b.size() == data.size(); };
+  for ( int ms = 0; ms < 100'000 and not done(); ++ms ) {
+    while ( not to_b.empty() or not to_a.empty() ) {
+      deliver( to_b, b, from_b );
+      deliver( to_a, a, from_a );
+    }
+    drain( a, received_a );
+    drain( b, received_b );
+    a.tick( 1, from_a );
+    b.tick( 1, from_b );
+  }
+
+  if ( received_a != data or received_b != data ) {
+    throw runtime_error( "streams did not arrive intact" );
+  }
+  return with_sack;
+}
+
+void program_body()
+{
+  const string data( 30'000, 'x' );
+
+  // the sender's own MSS is the smaller
+  auto result = transfer( 536, 1460, data );
+  expect( result.mss, 536, "MSS agreed with a larger peer MSS" );
+  expect( result.largest_payload, 536, "largest payload with a larger peer MSS" );
+
+  // the receiver's advertised MSS is the smaller
+  result = transfer( 1460, 536, data );
+  expect( result.mss, 536, "MSS agreed with a smaller peer MSS" );
+  expect( result.largest_payload, 536, "largest payload with a smaller peer MSS" );
+
+  // both sides agree on a large MSS: the stream needs fewer segments than at the default
+  result = transfer( 1460, 1460, data );
+  expect( result.mss, 1460, "MSS agreed by both sides" );
+  expect( result.largest_payload, 1460, "largest payload with 1460 on both sides" );
+  const auto at_default = transfer( TCPConfig::MAX_PAYLOAD_SIZE, TCPConfig::MAX_PAYLOAD_SIZE, data );
+  expect( at_default.largest_payload, TCPConfig::MAX_PAYLOAD_SIZE, "largest payload at the default MSS" );
+  if ( result.segments_with_data >= at_default.segments_with_data ) {
+    throw runtime_error( "a larger MSS did not cut the number of segments" );
+  }
+
+  // a SYN with every option still fits them in 40 bytes, sending only as many SACK blocks as there is room for
+  TCPMessage syn;
+  syn.sender.SYN = true;
+  syn.receiver.ackno = Wrap32 { 1 };
+  syn.receiver.mss = 1460;
+  syn.receiver.window_scale = 7;
+  syn.receiver.sack_permitted = true;
+  for ( uint32_t i = 0; i < TCPReceiverMessage::MAX_SACK_BLOCKS; ++i ) {
+    syn.receiver.sack.push_back( { Wrap32 { 100 + 20 * i }, Wrap32 { 110 + 20 * i } } );
+  }
+  expect( TCPSegment::options_length( syn.receiver, true ), 40, "option bytes on a SYN with every option" );
+  const auto parsed = over_the_wire( syn );
+  expect( parsed.receiver.mss.value_or( 0 ), 1460, "MSS on a SYN with every option" );
+  expect( parsed.receiver.window_scale.value_or( 0 ), 7, "window scale on a SYN with every option" );
+  expect( parsed.receiver.sack.size(), 3, "SACK blocks on a SYN with every option" );
+
+  // data segments carrying SACK blocks make room for them within the MSS
+  if ( lossy_exchange( 1460, data ) == 0 ) {
+    throw runtime_error( "no segment with data carried SACK blocks" );
+  }
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "parser.hh"
+#include "tcp_peer.hh"
+#include "tcp_segment.hh"
+
+#include <cstddef>
+#include <deque>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+// Helpers for tests that join TCPPeers back to back and exchange segments between them
+
+// Carry a message through the TCP wire format and back, as the TUN and UDP adapters do, so that its options
+// have to survive serialize() and parse()
+inline TCPMessage over_the_wire( const TCPMessage& msg )
+{
+  TCPSegment seg { msg, { 1234, 5678, 0 } };
+  seg.compute_checksum( 0 );
+  TCPSegment parsed;
+  if ( not parse( parsed, serialize( seg ), 0 ) ) {
+    throw std::runtime_error( "segment did not parse" );
+  }
+  return parsed.message;
+}
+
+// Hand every queued message to `peer`, including any queued while doing so, with `reply` for its answers
+inline void deliver( std::deque<TCPMessage>& queue, TCPPeer& peer, const TCPPeer::TransmitFunction& reply )
+{
+  while ( not queue.empty() ) {
+    auto msg = std::move( queue.front() );
+    queue.pop_front();
+    peer.receive( std::move( msg ), reply );
+  }
+}
+
+// Read everything `peer` has received into `received`, and let it reassemble more
+inline void drain( TCPPeer& peer, std::string& received )
+{
+  auto& reader = peer.inbound_reader();
+  while ( reader.bytes_buffered() ) {
+    received += reader.peek();
+    reader.pop( received.size() - reader.bytes_popped() );
+  }
+  peer.inbound_drained();
+}
+
+inline void expect( size_t actual, size_t expected, const std::string& what )
+{
+  if ( actual != expected ) {
+    throw std::runtime_error( what + ": expected " + std::to_string( expected ) + ", got "
+                              + std::to_string( actual ) );
+  }
+}
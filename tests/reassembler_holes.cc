@@ -2,6 +2,7 @@
 
 #include <exception>
 #include <iostream>
+#include <string>
 
 using namespace std;
 
@@ -129,6 +130,24 @@ int main()
       test.execute( ReadAll( "" ) );
       test.execute( IsFinished { true } );
     }
+
+    for ( const auto engine : { Reassembler::Engine::Map, Reassembler::Engine::Bitmap } ) {
+      ReassemblerTestHarness test { "holes the recent insertions no longer reach", 64, engine };
+
+      // move the window along, so the bitmap's ring wraps around under the ranges below
+      test.execute( Insert { string( 40, 'a' ), 0 } );
+      test.execute( ReadAll( string( 40, 'a' ) ) );
+
+      test.execute( Insert { "b", 45 } );
+      test.execute( Insert { "c", 62 } );
+      for ( uint64_t i = 0; i < 12; ++i ) {
+        test.execute( Insert { "d", 80 + i } );
+      }
+      test.execute( ExpectRecentRanges { { { 80, 92 }, { 45, 46 }, { 62, 63 } }, 4 } );
+      test.execute( ExpectRecentRanges { { { 80, 92 }, { 45, 46 } }, 2 } );
+      test.execute( Insert { "x", 41 } );
+      test.execute( ExpectRecentRanges { { { 41, 42 }, { 80, 92 }, { 45, 46 }, { 62, 63 } }, 4 } );
+    }
   } catch ( const exception& e ) {
     cerr << "Exception: " << e.what() << endl;
     return EXIT_FAILURE;
@@ -0,0 +1,115 @@
+#include "interval_set.hh"
+
+#include <iostream>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Check an IntervalSet against a std::set of every index it should contain
+void check( const IntervalSet& ranges, const set<uint64_t>& expected, const string& when )
+{
+  set<uint64_t> actual;
+  uint64_t previous_end = 0;
+  for ( const auto& range : ranges.ranges() ) {
+    if ( range.begin >= range.end or ( not actual.empty() and range.begin <= previous_end ) ) {
+      throw runtime_error( when + ": ranges are empty, unsorted, overlapping or adjacent" );
+    }
+    for ( auto i = range.begin; i < range.end; ++i ) {
+      actual.insert( i );
+    }
+    previous_end = range.end;
+  }
+  if ( actual != expected ) {
+    throw runtime_error( when + ": IntervalSet holds the wrong indices" );
+  }
+  if ( ranges.size() != expected.size() ) {
+    throw runtime_error( when + ": size() is " + to_string( ranges.size() ) + ", expected "
+                         + to_string( expected.size() ) );
+  }
+}
+
+void random_test( const size_t random_seed )
+{
+  default_random_engine rd { random_seed };
+  uniform_int_distribution<uint64_t> index { 0, 4000 };
+  uniform_int_distribution<uint64_t> length { 0, 50 };
+
+  IntervalSet ranges;
+  set<uint64_t> expected;
+  vector<IntervalSet::Interval> filled;
+  uint64_t floor = 0;
+
+  for ( int step = 0; step < 3000; ++step ) {
+    const auto begin = index( rd );
+    const auto end = begin + length( rd );
+    const string when = "step " + to_string( step ) + " adding [" + to_string( begin ) + ", " + to_string( end )
+                        + ")";
+
+    // the holes reported must be exactly the indices that were missing
+    set<uint64_t> missing;
+    for ( auto i = begin; i < end; ++i ) {
+      if ( not expected.contains( i ) ) {
+        missing.insert( i );
+      }
+    }
+    filled.clear();
+    ranges.add( begin, end, filled );
+    set<uint64_t> reported;
+    for ( const auto& hole : filled ) {
+      for ( auto i = hole.begin; i < hole.end; ++i ) {
+        reported.insert( i );
+      }
+    }
+    if ( reported != missing ) {
+      throw runtime_error( when + ": add() reported the wrong holes" );
+    }
+    expected.insert( missing.begin(), missing.end() );
+    check( ranges, expected, when );
+
+    if ( step % 100 == 99 ) {
+      floor += 200;
+      ranges.remove_below( floor );
+      expected.erase( expected.begin(), expected.lower_bound( floor ) );
+      check( ranges, expected, "after remove_below(" + to_string( floor ) + ")" );
+    }
+  }
+}
+
+void program_body()
+{
+  IntervalSet ranges;
+  vector<IntervalSet::Interval> filled;
+
+  ranges.add( 10, 20, filled );
+  ranges.add( 30, 40, filled );
+  ranges.add( 20, 30, filled ); // fills the gap exactly: everything merges into one range
+  if ( ranges.ranges().size() != 1 or ranges.front().begin != 10 or ranges.front().end != 40 ) {
+    throw runtime_error( "adjacent ranges were not merged" );
+  }
+
+  filled.clear();
+  ranges.holes( 0, 50, filled );
+  if ( filled.size() != 2 or filled[0].begin != 0 or filled[0].end != 10 or filled[1].begin != 40
+       or filled[1].end != 50 ) {
+    throw runtime_error( "holes() returned the wrong ranges" );
+  }
+
+  random_test( 1234 );
+  random_test( 98765 );
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,135 @@
+#include "reassembler_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    for ( const auto engine : { Reassembler::Engine::Map, Reassembler::Engine::Bitmap } ) {
+      {
+        ReassemblerTestHarness test { "duplicate and overlapping bytes are counted", 16, engine };
+
+        test.execute( Insert { "abcd", 0 } );
+        test.execute( Insert { "ab", 0 } );
+        test.execute( DuplicateBytes( 2 ) );
+        test.execute( Insert { "cdef", 2 } );
+        test.execute( OverlapBytes( 2 ) );
+
+        test.execute( Insert { "ijk", 8 } );
+        test.execute( Insert { "jk", 9 } );
+        test.execute( DuplicateBytes( 4 ) );
+        test.execute( Insert { "hijkl", 7 } );
+        test.execute( OverlapBytes( 5 ) );
+        test.execute( BytesPending( 5 ) );
+        test.execute( BytesDropped( 0 ) );
+
+        test.execute( Insert { "g", 6 } );
+        test.execute( BytesPushed( 12 ) );
+        test.execute( ReadAll( "abcdefghijkl" ) );
+      }
+
+      {
+        ReassemblerTestHarness test { "bytes beyond the window are dropped", 4, engine };
+
+        test.execute( Insert { "abcdef", 0 } );
+        test.execute( BytesDropped( 2 ) );
+        test.execute( Insert { "xy", 10 } );
+        test.execute( BytesDropped( 4 ) );
+        test.execute( ReadAll( "abcd" ) );
+      }
+
+      {
+        ReassemblerTestHarness test { "a small hole fill does not keep its whole payload", 2000, engine };
+        const string data( 1010, 'x' );
+
+        test.execute( Insert { data.substr( 11 ), 11 } );
+        test.execute( BytesRetained( 999 ) );
+        test.execute( Insert { data.substr( 10 ), 10 } ); // brings one new byte
+        test.execute( BytesPending( 1000 ) );
+        test.execute( BytesRetained( 1000 ) );
+        test.execute( Insert { data.substr( 0, 10 ), 0 } );
+        test.execute( BytesRetained( 0 ) );
+        test.execute( ReadAll( data ) );
+      }
+
+      {
+        ReassemblerTestHarness test { "per-reassembler limit, evict furthest", 100, engine };
+
+        test.execute( SetLimits( { .max_pending = 5 } ) );
+        test.execute( Insert { "cd", 2 } );
+        test.execute( Insert { "ghi", 6 } );
+        test.execute( BytesPending( 5 ) );
+        test.execute( Insert { "e", 4 } ); // over by one: "i" goes
+        test.execute( BytesPending( 5 ) );
+        test.execute( BytesDropped( 1 ) );
+        test.execute( Insert { "z", 50 } ); // furthest of all: goes itself
+        test.execute( BytesPending( 5 ) );
+        test.execute( BytesDropped( 2 ) );
+
+        test.execute( Insert { "ab", 0 } );
+        test.execute( Insert { "f", 5 } );
+        test.execute( ReadAll( "abcdefgh" ) );
+        test.execute( BytesPending( 0 ) );
+      }
+
+      {
+        ReassemblerTestHarness test { "evicting from a large payload frees the evicted bytes", 2000, engine };
+        const string data( 1010, 'x' );
+
+        test.execute( SetLimits( { .max_pending = 100 } ) );
+        test.execute( Insert { data.substr( 10 ), 10 } );
+        test.execute( BytesPending( 100 ) );
+        test.execute( BytesRetained( 100 ) );
+        test.execute( BytesDropped( 900 ) );
+        test.execute( Insert { data.substr( 0, 10 ), 0 } );
+        test.execute( ReadAll( data.substr( 0, 110 ) ) );
+        test.execute( BytesRetained( 0 ) );
+      }
+
+      {
+        ReassemblerTestHarness test { "per-reassembler limit, evict incoming", 100, engine };
+
+        test.execute( SetLimits( { .max_pending = 5, .eviction = Reassembler::Eviction::Incoming } ) );
+        test.execute( Insert { "ghi", 6 } );
+        test.execute( Insert { "cdef", 2 } ); // only "cd" fits
+        test.execute( BytesPending( 5 ) );
+        test.execute( BytesRetained( 5 ) );
+        test.execute( BytesDropped( 2 ) );
+
+        test.execute( Insert { "ab", 0 } ); // in order: straight to the stream
+        test.execute( ReadAll( "abcd" ) );
+        test.execute( Insert { "ef", 4 } );
+        test.execute( ReadAll( "efghi" ) );
+      }
+
+      {
+        auto budget = make_shared<PendingBudget>( 6 );
+        ReassemblerTestHarness first { "shared budget (first)", 100, engine };
+        ReassemblerTestHarness second { "shared budget (second)", 100, engine };
+
+        first.execute( SetLimits( { .shared = budget } ) );
+        second.execute( SetLimits( { .shared = budget } ) );
+        first.execute( Insert { "bcde", 1 } );
+        second.execute( Insert { "bcde", 1 } ); // only room for two more bytes
+        second.execute( BytesPending( 2 ) );
+        second.execute( BytesDropped( 2 ) );
+
+        first.execute( Insert { "a", 0 } ); // frees first's share
+        first.execute( ReadAll( "abcde" ) );
+        second.execute( Insert { "xyz", 10 } );
+        second.execute( BytesPending( 5 ) );
+        second.execute( BytesDropped( 2 ) );
+      }
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -13,9 +13,10 @@
 using namespace std;
 using namespace std::chrono;
 
-void speed_test( const size_t num_chunks,   // NOLINT(bugprone-easily-swappable-parameters)
-                 const size_t capacity,     // NOLINT(bugprone-easily-swappable-parameters)
-                 const size_t random_seed ) // NOLINT(bugprone-easily-swappable-parameters)
+void speed_test( const size_t num_chunks,  // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t capacity,    // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t random_seed, // NOLINT(bugprone-easily-swappable-parameters)
+                 const Reassembler::Engine engine )
 {
   // Generate the data to be written
   const string data = [&] {
@@ -36,7 +37,7 @@ void speed_test( const size_t num_chunks,   // NOLINT(bugprone-easily-swappable-
     split_data.emplace( i + 1, data.substr( i + 1, capacity * 2 ), i + 1 + capacity * 2 >= data.size() );
   }
 
-  Reassembler reassembler { ByteStream { capacity } };
+  Reassembler reassembler { ByteStream { capacity }, engine };
 
   string output_data;
   output_data.reserve( data.size() );
@@ -71,11 +72,12 @@ void speed_test( const size_t num_chunks,   // NOLINT(bugprone-easily-swappable-
   fstream debug_output;
   debug_output.open( "/dev/tty" );
 
-  cout << "Reassembler to ByteStream with capacity=" << capacity << " reached " << fixed << setprecision( 2 )
-       << gigabits_per_second << " Gbit/s.\n";
+  const auto* name = engine == Reassembler::Engine::Bitmap ? "bitmap" : "map";
+  cout << "Reassembler (" << name << ") to ByteStream with capacity=" << capacity << " reached " << fixed
+       << setprecision( 2 ) << gigabits_per_second << " Gbit/s.\n";
 
-  debug_output << "             Reassembler throughput: " << fixed << setprecision( 2 ) << gigabits_per_second
-               << " Gbit/s\n";
+  debug_output << "             Reassembler (" << name << ") throughput: " << fixed << setprecision( 2 )
+               << gigabits_per_second << " Gbit/s\n";
 
   if ( gigabits_per_second < 0.1 ) {
     throw runtime_error( "Reassembler did not meet minimum speed of 0.1 Gbit/s." );
@@ -84,7 +86,9 @@ void speed_test( const size_t num_chunks,   // NOLINT(bugprone-easily-swappable-
 
 void program_body()
 {
-  speed_test( 10000, 1500, 1370 );
+  for ( const auto engine : { Reassembler::Engine::Map, Reassembler::Engine::Bitmap } ) {
+    speed_test( 10000, 1500, 1370, engine );
+  }
 }
 
 int main()
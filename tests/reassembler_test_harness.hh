@@ -7,6 +7,7 @@
 #include <optional>
 #include <sstream>
 #include <utility>
+#include <vector>
 
 template<std::derived_from<TestStep<ByteStream>> T>
 struct ReassemblerTestStep : public TestStep<Reassembler>
@@ -27,10 +28,13 @@ struct ReassemblerTestStep : public TestStep<Reassembler>
 class ReassemblerTestHarness : public TestHarness<Reassembler>
 {
 public:
-  ReassemblerTestHarness( std::string test_name, uint64_t capacity )
+  ReassemblerTestHarness( std::string test_name,
+                          uint64_t capacity,
+                          Reassembler::Engine engine = Reassembler::Engine::Map )
     : TestHarness( move( test_name ),
-                   "capacity=" + std::to_string( capacity ),
-                   { Reassembler { ByteStream { capacity } } } )
+                   "capacity=" + std::to_string( capacity )
+                     + ( engine == Reassembler::Engine::Bitmap ? ", engine=bitmap" : "" ),
+                   { Reassembler { ByteStream { capacity }, engine } } )
   {}
 
   template<std::derived_from<TestStep<ByteStream>> T>
@@ -49,6 +53,91 @@ struct BytesPending : public ConstExpectNumber<Reassembler, uint64_t>
   uint64_t value( const Reassembler& r ) const override { return r.bytes_pending(); }
 };
 
+struct BytesRetained : public ConstExpectNumber<Reassembler, uint64_t>
+{
+  using ConstExpectNumber::ConstExpectNumber;
+  std::string name() const override { return "bytes_retained"; }
+  uint64_t value( const Reassembler& r ) const override { return r.bytes_retained(); }
+};
+
+struct BytesDropped : public ConstExpectNumber<Reassembler, uint64_t>
+{
+  using ConstExpectNumber::ConstExpectNumber;
+  std::string name() const override { return "stats().bytes_dropped"; }
+  uint64_t value( const Reassembler& r ) const override { return r.stats().bytes_dropped; }
+};
+
+struct DuplicateBytes : public ConstExpectNumber<Reassembler, uint64_t>
+{
+  using ConstExpectNumber::ConstExpectNumber;
+  std::string name() const override { return "stats().duplicate_bytes"; }
+  uint64_t value( const Reassembler& r ) const override { return r.stats().duplicate_bytes; }
+};
+
+struct OverlapBytes : public ConstExpectNumber<Reassembler, uint64_t>
+{
+  using ConstExpectNumber::ConstExpectNumber;
+  std::string name() const override { return "stats().overlap_bytes"; }
+  uint64_t value( const Reassembler& r ) const override { return r.stats().overlap_bytes; }
+};
+
+struct ExpectRecentRanges : public Expectation<Reassembler>
+{
+  std::vector<std::pair<uint64_t, uint64_t>> ranges_;
+  size_t max_;
+
+  ExpectRecentRanges( std::vector<std::pair<uint64_t, uint64_t>> ranges, size_t max )
+    : ranges_( std::move( ranges ) ), max_( max )
+  {}
+
+  static std::string describe( const std::vector<std::pair<uint64_t, uint64_t>>& ranges )
+  {
+    std::ostringstream ss;
+    for ( const auto& [begin, end] : ranges ) {
+      ss << " [" << begin << ", " << end << ")";
+    }
+    return ranges.empty() ? " (none)" : ss.str();
+  }
+
+  std::string description() const override
+  {
+    return "recent_ranges (up to " + std::to_string( max_ ) + ") are" + describe( ranges_ );
+  }
+
+  void execute( Reassembler& r ) const override
+  {
+    std::vector<IntervalSet::Interval> out;
+    r.recent_ranges( out, max_ );
+    std::vector<std::pair<uint64_t, uint64_t>> actual;
+    for ( const auto& range : out ) {
+      actual.emplace_back( range.begin, range.end );
+    }
+    if ( actual != ranges_ ) {
+      throw ExpectationViolation( "recent_ranges were" + describe( actual ) );
+    }
+  }
+};
+
+struct SetLimits : public Action<Reassembler>
+{
+  Reassembler::Limits limits_;
+
+  explicit SetLimits( Reassembler::Limits limits ) : limits_( std::move( limits ) ) {}
+
+  std::string description() const override
+  {
+    std::ostringstream ss;
+    ss << "set limits: max_pending=" << limits_.max_pending;
+    if ( limits_.shared ) {
+      ss << " shared=" << limits_.shared->limit();
+    }
+    ss << ( limits_.eviction == Reassembler::Eviction::Furthest ? " evict furthest" : " evict incoming" );
+    return ss.str();
+  }
+
+  void execute( Reassembler& r ) const override { r.set_limits( limits_ ); }
+};
+
 struct Insert : public Action<Reassembler>
 {
   std::string data_;
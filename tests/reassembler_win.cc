@@ -21,7 +21,8 @@ int main()
 
     // overlapping segments
     for ( unsigned rep_no = 0; rep_no < NREPS; ++rep_no ) {
-      ReassemblerTestHarness sr { "win test " + to_string( rep_no ), NSEGS * MAX_SEG_LEN };
+      const auto engine = rep_no % 2 ? Reassembler::Engine::Bitmap : Reassembler::Engine::Map;
+      ReassemblerTestHarness sr { "win test " + to_string( rep_no ), NSEGS * MAX_SEG_LEN, engine };
 
       vector<tuple<size_t, size_t>> seq_size;
       size_t offset = 0;
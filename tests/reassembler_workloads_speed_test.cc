@@ -0,0 +1,168 @@
+#include "alloc_counter.hh"
+#include "reassembler.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+/*
+ * Reassembler throughput on the arrival patterns that are hard on it, for each engine:
+ *
+ *   reversed      each window of the stream arrives back to front
+ *   shuffled      each window arrives in a random order
+ *   tiny          1-byte segments, shuffled within each window
+ *   covering      small segments with holes between them, then one segment covering them all
+ *   duplicated    every segment arrives four times, shuffled within each window
+ *   near_capacity segments longer than the window, starting anywhere in it
+ *
+ * Each reports Gbit/s of stream reassembled, the peaks of bytes_pending() and bytes_retained(), and the peak
+ * heap used by the Reassembler, its ByteStream and the payloads they hold.
+ */
+
+// (first index, length, last) of each segment; the payloads are cut from the data as they are inserted
+using Segments = vector<tuple<uint64_t, uint64_t, bool>>;
+
+// Cut [begin, end) of `data` into segments of `size` bytes (the last one may be shorter)
+void cut( const string& data, uint64_t begin, uint64_t end, uint64_t size, Segments& out )
+{
+  for ( auto i = begin; i < end; i += size ) {
+    const auto len = min( size, end - i );
+    out.emplace_back( i, len, i + len == data.size() );
+  }
+}
+
+Segments make_workload( const string& workload, const string& data, uint64_t capacity, default_random_engine& rd )
+{
+  Segments all;
+  for ( uint64_t window = 0; window < data.size(); window += capacity ) {
+    const auto end = min( window + capacity, static_cast<uint64_t>( data.size() ) );
+    Segments segments;
+
+    if ( workload == "reversed" ) {
+      cut( data, window, end, 1000, segments );
+      reverse( segments.begin(), segments.end() );
+    } else if ( workload == "shuffled" ) {
+      cut( data, window, end, 1000, segments );
+      shuffle( segments.begin(), segments.end(), rd );
+    } else if ( workload == "tiny" ) {
+      cut( data, window, end, 1, segments );
+      shuffle( segments.begin(), segments.end(), rd );
+    } else if ( workload == "covering" ) {
+      // every other 10-byte piece except the first, then the whole window at once
+      Segments pieces;
+      cut( data, window, end, 10, pieces );
+      for ( size_t i = 1; i < pieces.size(); i += 2 ) {
+        segments.push_back( pieces[i] );
+      }
+      shuffle( segments.begin(), segments.end(), rd );
+      segments.emplace_back( window, end - window, end == data.size() );
+    } else if ( workload == "duplicated" ) {
+      Segments once;
+      cut( data, window, end, 1000, once );
+      for ( int copy = 0; copy < 4; ++copy ) {
+        segments.insert( segments.end(), once.begin(), once.end() );
+      }
+      shuffle( segments.begin(), segments.end(), rd );
+    } else if ( workload == "near_capacity" ) {
+      // segments of 1.5 windows starting anywhere in this one, then one from its start to finish it
+      uniform_int_distribution<uint64_t> start { window + 1, end - 1 };
+      for ( int i = 0; i < 8; ++i ) {
+        const auto first = start( rd );
+        const auto len = min( capacity * 3 / 2, data.size() - first );
+        segments.emplace_back( first, len, first + len == data.size() );
+      }
+      segments.emplace_back( window, end - window, end == data.size() );
+    } else {
+      throw runtime_error( "unknown workload " + workload );
+    }
+
+    all.insert( all.end(), segments.begin(), segments.end() );
+  }
+  return all;
+}
+
+void speed_test( const string& workload,
+                 const size_t len,      // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t capacity, // NOLINT(bugprone-easily-swappable-parameters)
+                 const Reassembler::Engine engine )
+{
+  default_random_engine rd { 1370 };
+  string data( len, 0 );
+  generate( data.begin(), data.end(), [&] { return rd(); } );
+  const auto segments = make_workload( workload, data, capacity, rd );
+  string output_data;
+  output_data.reserve( data.size() );
+  uint64_t peak_pending = 0;
+  uint64_t peak_retained = 0;
+
+  heap::peak = heap::in_use;
+  const auto heap_before = heap::in_use;
+  Reassembler reassembler { ByteStream { capacity }, engine };
+
+  const auto start_time = steady_clock::now();
+  for ( const auto& [first_index, length, last] : segments ) {
+    reassembler.insert( first_index, data.substr( first_index, length ), last );
+    peak_pending = max( peak_pending, reassembler.bytes_pending() );
+    peak_retained = max( peak_retained, reassembler.bytes_retained() );
+
+    while ( reassembler.reader().bytes_buffered() ) {
+      output_data += reassembler.reader().peek();
+      reassembler.reader().pop( output_data.size() - reassembler.reader().bytes_popped() );
+    }
+  }
+  const auto stop_time = steady_clock::now();
+
+  if ( not reassembler.reader().is_finished() or data != output_data ) {
+    throw runtime_error( "Reassembler did not reassemble the " + workload + " workload" );
+  }
+
+  const auto test_duration = duration_cast<duration<double>>( stop_time - start_time );
+  const auto gigabits_per_second = 8 * static_cast<double>( len ) / test_duration.count() / 1e9;
+  const auto* name = engine == Reassembler::Engine::Bitmap ? "bitmap" : "map";
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  cout << "Reassembler (" << name << ") " << setw( 13 ) << left << workload << right
+       << " with capacity=" << setw( 6 ) << capacity << " reached " << fixed << setprecision( 2 ) << setw( 6 )
+       << gigabits_per_second << " Gbit/s, peak pending=" << setw( 6 ) << peak_pending
+       << " bytes, retained=" << setw( 6 ) << peak_retained << " bytes, heap=" << setw( 5 )
+       << ( heap::peak - heap_before ) / 1024 << " KiB.\n";
+
+  debug_output << "             Reassembler (" << name << ", " << workload << ") throughput: " << fixed
+               << setprecision( 2 ) << gigabits_per_second << " Gbit/s\n";
+}
+
+void program_body()
+{
+  for ( const auto engine : { Reassembler::Engine::Map, Reassembler::Engine::Bitmap } ) {
+    speed_test( "reversed", 1 << 23, 65536, engine );
+    speed_test( "shuffled", 1 << 23, 65536, engine );
+    speed_test( "tiny", 1 << 19, 4096, engine );
+    speed_test( "covering", 1 << 22, 65536, engine );
+    speed_test( "duplicated", 1 << 22, 65536, engine );
+    speed_test( "near_capacity", 1 << 22, 1500, engine );
+  }
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -8,6 +8,7 @@
 #include <optional>
 #include <sstream>
 #include <utility>
+#include <vector>
 
 template<std::derived_from<TestStep<Reassembler>> T>
 struct DirectReassemblerTest : public TestStep<TCPReceiver>
@@ -111,6 +112,106 @@ struct ExpectAcknoBetween : public Expectation<TCPReceiver>
   }
 };
 
+struct ExpectSACK : public Expectation<TCPReceiver>
+{
+  std::vector<std::pair<Wrap32, Wrap32>> blocks_;
+
+  explicit ExpectSACK( std::vector<std::pair<Wrap32, Wrap32>> blocks ) : blocks_( std::move( blocks ) ) {}
+
+  static std::string describe( const std::vector<std::pair<Wrap32, Wrap32>>& blocks )
+  {
+    std::ostringstream ss;
+    for ( const auto& [begin, end] : blocks ) {
+      ss << " [" << begin << ", " << end << ")";
+    }
+    return blocks.empty() ? " (none)" : ss.str();
+  }
+
+  std::string description() const override { return "SACK blocks are" + describe( blocks_ ); }
+
+  void execute( TCPReceiver& rs ) const override
+  {
+    std::vector<std::pair<Wrap32, Wrap32>> actual;
+    for ( const auto& block : rs.send().sack ) {
+      actual.emplace_back( block.begin, block.end );
+    }
+    if ( actual != blocks_ ) {
+      throw ExpectationViolation( "TCPReceiver sent SACK blocks" + describe( actual ) );
+    }
+  }
+};
+
+// The window scale offered alongside our SYN (with the window that goes with it)
+struct ExpectWindowScale : public ExpectNumber<TCPReceiver, std::optional<uint8_t>>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "window_scale"; }
+  std::optional<uint8_t> value( TCPReceiver& rs ) const override { return rs.send( true ).window_scale; }
+};
+
+struct ExpectSynWindow : public ExpectNumber<TCPReceiver, uint16_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "window_size alongside SYN"; }
+  uint16_t value( TCPReceiver& rs ) const override { return rs.send( true ).window_size; }
+};
+
+struct ExpectMSS : public ExpectNumber<TCPReceiver, std::optional<uint16_t>>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "mss alongside SYN"; }
+  std::optional<uint16_t> value( TCPReceiver& rs ) const override { return rs.send( true ).mss; }
+};
+
+struct AdvertiseMSS : public Action<TCPReceiver>
+{
+  uint16_t mss_;
+
+  explicit AdvertiseMSS( uint16_t mss ) : mss_( mss ) {}
+  std::string description() const override { return "advertise MSS " + std::to_string( mss_ ); }
+  void execute( TCPReceiver& rs ) const override { rs.advertise_mss( mss_ ); }
+};
+
+struct OfferWindowScale : public Action<TCPReceiver>
+{
+  std::string description() const override { return "offer window scaling"; }
+  void execute( TCPReceiver& rs ) const override { rs.offer_window_scale(); }
+};
+
+struct PeerWindowScale : public Action<TCPReceiver>
+{
+  bool offered_;
+
+  explicit PeerWindowScale( bool offered ) : offered_( offered ) {}
+  std::string description() const override
+  {
+    return offered_ ? "peer offered window scaling" : "peer did not offer window scaling";
+  }
+  void execute( TCPReceiver& rs ) const override { rs.set_peer_window_scale( offered_ ); }
+};
+
+struct ExpectSACKPermitted : public ExpectBool<TCPReceiver>
+{
+  using ExpectBool::ExpectBool;
+  std::string name() const override { return "sack_permitted alongside SYN"; }
+  bool value( TCPReceiver& rs ) const override { return rs.send( true ).sack_permitted; }
+};
+
+struct OfferSACK : public Action<TCPReceiver>
+{
+  std::string description() const override { return "offer SACK"; }
+  void execute( TCPReceiver& rs ) const override { rs.offer_sack(); }
+};
+
+struct PeerSACK : public Action<TCPReceiver>
+{
+  bool offered_;
+
+  explicit PeerSACK( bool offered ) : offered_( offered ) {}
+  std::string description() const override { return offered_ ? "peer offered SACK" : "peer did not offer SACK"; }
+  void execute( TCPReceiver& rs ) const override { rs.set_peer_sack( offered_ ); }
+};
+
 struct HasAckno : public ExpectBool<TCPReceiver>
 {
   using ExpectBool::ExpectBool;
@@ -112,6 +112,16 @@ int main()
       TCPReceiverTestHarness test { "window size at 10M", 10'000'000 };
       test.execute( ExpectWindow { UINT16_MAX } );
     }
+
+    {
+      TCPReceiverTestHarness test { "MSS advertised only alongside SYN", 4000 };
+      test.execute( ExpectMSS { nullopt } );
+      test.execute( AdvertiseMSS { 1460 } );
+      test.execute( ExpectMSS { 1460 } );
+      test.execute( SegmentArrives {}.with_syn().with_seqno( 0 ) );
+      test.execute( ExpectMSS { 1460 } );
+      test.execute( ExpectAckno { Wrap32 { 1 } } );
+    }
   } catch ( const exception& e ) {
     cerr << e.what() << endl;
     return 1;
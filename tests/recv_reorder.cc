@@ -127,6 +127,73 @@ int main()
       test.execute( BytesPushed { 8 } );
     }
 
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "SACK blocks, most recent first", 2358 };
+      test.execute( OfferSACK {} );
+      test.execute( ExpectSACKPermitted { true } );
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( PeerSACK { true } );
+      test.execute( ExpectSACK { {} } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 5 ).with_data( "ef" ) );
+      test.execute( ExpectSACK { { { Wrap32 { isn + 5 }, Wrap32 { isn + 7 } } } } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 10 ).with_data( "jk" ) );
+      test.execute( ExpectSACK { { { Wrap32 { isn + 10 }, Wrap32 { isn + 12 } },
+                                   { Wrap32 { isn + 5 }, Wrap32 { isn + 7 } } } } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 7 ).with_data( "gh" ) );
+      test.execute( ExpectSACK { { { Wrap32 { isn + 5 }, Wrap32 { isn + 9 } },
+                                   { Wrap32 { isn + 10 }, Wrap32 { isn + 12 } } } } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abcd" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 9 } } );
+      test.execute( ExpectSACK { { { Wrap32 { isn + 10 }, Wrap32 { isn + 12 } } } } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 9 ).with_data( "i" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 12 } } );
+      test.execute( ExpectSACK { {} } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "SACK blocks, at most four", 2358 };
+      test.execute( OfferSACK {} );
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( PeerSACK { true } );
+      for ( uint32_t i = 1; i <= 6; ++i ) {
+        test.execute( SegmentArrives {}.with_seqno( isn + 1 + 2 * i ).with_data( "x" ) );
+      }
+      test.execute( ExpectSACK { { { Wrap32 { isn + 13 }, Wrap32 { isn + 14 } },
+                                   { Wrap32 { isn + 11 }, Wrap32 { isn + 12 } },
+                                   { Wrap32 { isn + 9 }, Wrap32 { isn + 10 } },
+                                   { Wrap32 { isn + 7 }, Wrap32 { isn + 8 } } } } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "SACK blocks keep ranges the recent segments didn't touch", 2358 };
+      test.execute( OfferSACK {} );
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( PeerSACK { true } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 11 ).with_data( string( 10, 'x' ) ) );
+      for ( uint32_t i = 0; i < 10; ++i ) {
+        test.execute( SegmentArrives {}.with_seqno( isn + 31 + 10 * i ).with_data( string( 10, 'y' ) ) );
+      }
+      test.execute( ExpectSACK { { { Wrap32 { isn + 31 }, Wrap32 { isn + 131 } },
+                                   { Wrap32 { isn + 11 }, Wrap32 { isn + 21 } } } } );
+    }
+
+    for ( const bool ours : { false, true } ) {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "no SACK blocks unless both sides offer SACK", 2358 };
+      if ( ours ) {
+        test.execute( OfferSACK {} );
+      }
+      test.execute( ExpectSACKPermitted { ours } );
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( PeerSACK { not ours } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 5 ).with_data( "ef" ) );
+      test.execute( ExpectSACK { {} } );
+      test.execute( BytesPending { 2 } );
+    }
+
   } catch ( const exception& e ) {
     cerr << e.what() << endl;
     return 1;
@@ -105,6 +105,49 @@ int main()
       test.execute( BytesPending( 0 ) );
     }
 
+    {
+      const size_t cap = 1 << 20;
+      const uint32_t isn = 1234;
+      TCPReceiverTestHarness test { "window scaled when both sides offer it", cap };
+      test.execute( OfferWindowScale {} );
+      test.execute( ExpectWindowScale { 5 } );
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( PeerWindowScale { true } );
+      test.execute( ExpectWindowScale { 5 } );
+      test.execute( ExpectSynWindow { UINT16_MAX } );
+      test.execute( ExpectWindow { ( 1 << 20 ) >> 5 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( string( 100, 'x' ) ) );
+      test.execute( ExpectWindow { ( ( 1 << 20 ) - 100 ) >> 5 } );
+      test.execute( ReadAll { string( 100, 'x' ) } );
+      test.execute( ExpectWindow { ( 1 << 20 ) >> 5 } );
+    }
+
+    {
+      const size_t cap = 1 << 20;
+      const uint32_t isn = 1234;
+      TCPReceiverTestHarness test { "window unscaled when peer doesn't offer scaling", cap };
+      test.execute( OfferWindowScale {} );
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( PeerWindowScale { false } );
+      test.execute( ExpectWindowScale { nullopt } );
+      test.execute( ExpectWindow { UINT16_MAX } );
+    }
+
+    {
+      TCPReceiverTestHarness test { "no window scale offered by default", 1 << 20 };
+      test.execute( ExpectWindowScale { nullopt } );
+      test.execute( PeerWindowScale { true } );
+      test.execute( ExpectWindow { UINT16_MAX } );
+    }
+
+    {
+      TCPReceiverTestHarness test { "small capacity offers a zero window scale", 4000 };
+      test.execute( OfferWindowScale {} );
+      test.execute( ExpectWindowScale { 0 } );
+      test.execute( PeerWindowScale { true } );
+      test.execute( ExpectWindow { 4000 } );
+    }
+
   } catch ( const exception& e ) {
     cerr << e.what() << endl;
     return 1;
@@ -295,6 +295,76 @@ int main()
       test.execute( ExpectMessage {}.with_payload_size( 0 ).with_seqno( isn + 4 ).with_fin( true ) );
     }
 
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "the smaller of our MSS and the peer's limits payload", cfg };
+      test.execute( SetMSS { 1460 } );
+      test.execute( ExpectMSS { 1460 } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( Push { string( 4000, 'x' ) } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 40000 ).with_mss( 1200 ) );
+      test.execute( ExpectMSS { 1200 } );
+      test.execute( ExpectMessage {}.with_payload_size( 1200 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1200 ).with_seqno( isn + 1201 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1200 ).with_seqno( isn + 2401 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 400 ).with_seqno( isn + 3601 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "payloads leave room for the options within the MSS", cfg };
+      test.execute( SetMSS { 1460 } );
+      test.execute( SetOptionBytes { 12, 36 } );
+      test.execute( Push { string( 3000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 40000 ).with_mss( 1460 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1424 ).with_seqno( isn + 1 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1424 ).with_seqno( isn + 1425 ) );
+      test.execute( ExpectMessage {}.with_payload_size( 152 ).with_seqno( isn + 2849 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "a duplicate SYN-ACK leaves the MSS and window alone", cfg };
+      test.execute( SetCongestionControl { CongestionAlgorithm::NewReno } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ).with_mss( 1000 ) );
+      test.execute( Push { string( 10000, 'x' ) } );
+      test.execute( AckReceived { Wrap32 { isn + 5001 } }.with_win( 60000 ) );
+      test.execute( ExpectCwnd { 12001 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ).with_mss( 500 ) );
+      test.execute( ExpectMSS { 1000 } );
+      test.execute( ExpectCwnd { 12001 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "a larger MSS from the peer doesn't raise ours", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( Push { string( 1500, 'x' ) } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 40000 ).with_mss( 1460 ) );
+      test.execute( ExpectMSS { TCPConfig::MAX_PAYLOAD_SIZE } );
+      test.execute( ExpectMessage {}.with_payload_size( TCPConfig::MAX_PAYLOAD_SIZE ) );
+      test.execute( ExpectMessage {}.with_payload_size( 1500 - TCPConfig::MAX_PAYLOAD_SIZE ) );
+    }
+
     {
       TCPConfig cfg;
       const Wrap32 isn( rd() );
@@ -0,0 +1,198 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+// Connect, then send each of `data`'s bytes in a segment of its own
+void send_bytes( TCPSenderTestHarness& test, Wrap32 isn, const string& data )
+{
+  test.execute( SetFastRetransmit { true } );
+  test.execute( Push {} );
+  test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+  test.execute( AckReceived { Wrap32 { isn + 1 } } );
+  for ( const char c : data ) {
+    test.execute( Push { string( 1, c ) } );
+    test.execute( ExpectMessage {}.with_data( string( 1, c ) ) );
+  }
+  test.execute( ExpectNoSegment {} );
+}
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "Fast retransmit on the third duplicate ack", cfg };
+      send_bytes( test, isn, "abcde" );
+      test.execute( AckReceived { Wrap32 { isn + 2 } } );
+      test.execute( AckReceived { Wrap32 { isn + 2 } } );
+      test.execute( AckReceived { Wrap32 { isn + 2 } } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectInRecovery { false } );
+      test.execute( AckReceived { Wrap32 { isn + 2 } } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 2 ).with_data( "b" ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectInRecovery { true } );
+      test.execute( AckReceived { Wrap32 { isn + 2 } } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 6 } } );
+      test.execute( ExpectInRecovery { false } );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+      test.execute( ExpectConsecutiveRetransmissions { 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "Window updates are not duplicate acks", cfg };
+      send_bytes( test, isn, "abcde" );
+      test.execute( AckReceived { Wrap32 { isn + 2 } }.with_win( 100 ) );
+      test.execute( AckReceived { Wrap32 { isn + 2 } }.with_win( 101 ) );
+      test.execute( AckReceived { Wrap32 { isn + 2 } }.with_win( 102 ) );
+      test.execute( AckReceived { Wrap32 { isn + 2 } }.with_win( 103 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectInRecovery { false } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "Duplicate acks wait for the RTO without fast retransmit", cfg };
+      send_bytes( test, isn, "abcde" );
+      test.execute( SetFastRetransmit { false } );
+      for ( int i = 0; i < 5; ++i ) {
+        test.execute( AckReceived { Wrap32 { isn + 2 } } );
+      }
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_data( "b" ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "A partial ack resends the next hole at once", cfg };
+      send_bytes( test, isn, "abcdef" );
+      for ( int i = 0; i < 3; ++i ) {
+        test.execute( AckReceived { Wrap32 { isn + 1 } } );
+      }
+      test.execute( ExpectMessage {}.with_data( "a" ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 3 } } );
+      test.execute( ExpectMessage {}.with_data( "c" ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectInRecovery { true } );
+      test.execute( AckReceived { Wrap32 { isn + 7 } } );
+      test.execute( ExpectInRecovery { false } );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "SACK recovery resends every hole it shows", cfg };
+      send_bytes( test, isn, "abcdefgh" );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }
+                      .with_sack( Wrap32 { isn + 4 }, Wrap32 { isn + 9 } )
+                      .with_sack( Wrap32 { isn + 2 }, Wrap32 { isn + 3 } ) );
+      test.execute( ExpectInRecovery { true } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 ).with_data( "a" ) );
+      test.execute( ExpectMessage {}.with_seqno( isn + 3 ).with_data( "c" ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 3 } }.with_sack( Wrap32 { isn + 4 }, Wrap32 { isn + 9 } ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { Wrap32 { isn + 9 } } );
+      test.execute( ExpectInRecovery { false } );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "SACK below DUP_THRESH segments waits for more", cfg };
+      send_bytes( test, isn, "abcd" );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_sack( Wrap32 { isn + 2 }, Wrap32 { isn + 4 } ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectInRecovery { false } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_sack( Wrap32 { isn + 2 }, Wrap32 { isn + 5 } ) );
+      test.execute( ExpectInRecovery { true } );
+      test.execute( ExpectMessage {}.with_data( "a" ) );
+      test.execute( ExpectNoSegment {} );
+    }
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "The window holds at ssthresh through fast recovery", cfg };
+      test.execute( SetCongestionControl { CongestionAlgorithm::NewReno } );
+      test.execute( SetFastRetransmit { true } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( Push { string( 10000, 'x' ) } );
+      test.execute( ExpectSeqnosInFlight { 10000 } );
+      for ( int i = 0; i < 3; ++i ) {
+        test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      }
+      test.execute( ExpectInRecovery { true } );
+      test.execute( ExpectCwnd { 5000 } );
+      test.execute( AckReceived { Wrap32 { isn + 6001 } }.with_win( 60000 ) );
+      test.execute( ExpectInRecovery { true } );
+      test.execute( ExpectCwnd { 5000 } );
+      test.execute( AckReceived { Wrap32 { isn + 10001 } }.with_win( 60000 ) );
+      test.execute( ExpectInRecovery { false } );
+      test.execute( ExpectCwnd { 5000 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "Only the first timeout for a segment cuts the window", cfg };
+      test.execute( SetCongestionControl { CongestionAlgorithm::Cubic } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 60000 ) );
+      test.execute( Push { string( 3000, 'x' ) } );
+      test.execute( ExpectSeqnosInFlight { 3000 } );
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectConsecutiveRetransmissions { 1 } );
+      test.execute( ExpectCwnd { 1000 } );
+      test.execute( Tick { 2UL * cfg.rt_timeout } );
+      test.execute( ExpectConsecutiveRetransmissions { 2 } );
+      // ssthresh is still 0.7 of the window before the first timeout, so slow start goes on past 2 MSS
+      test.execute( AckReceived { Wrap32 { isn + 1001 } }.with_win( 60000 ) );
+      test.execute( ExpectCwnd { 2000 } );
+      test.execute( AckReceived { Wrap32 { isn + 2001 } }.with_win( 60000 ) );
+      test.execute( ExpectCwnd { 3000 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -200,6 +200,81 @@ int main()
       test.execute( ExpectSeqnosInFlight { 0 } );
       test.execute( HasError { false } );
     }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "RTO adapts to measured RTT", cfg };
+      test.execute( SetRTOLimits { 10, 60000 } );
+      test.execute( ExpectSRTT { nullopt } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } } );
+      test.execute( ExpectSRTT { 100 } );
+      test.execute( ExpectRTTVAR { 50 } );
+      test.execute( ExpectRTO { 300 } );
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { Wrap32 { isn + 4 } } );
+      test.execute( ExpectSRTT { 100 } );
+      test.execute( ExpectRTTVAR { 37 } );
+      test.execute( ExpectRTO { 250 } );
+      test.execute( Push { "def" } );
+      test.execute( ExpectMessage {}.with_data( "def" ) );
+      test.execute( Tick { 249 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "def" ) );
+      test.execute( ExpectRTO { 500 } );
+      test.execute( Tick { 400 } );
+      test.execute( AckReceived { Wrap32 { isn + 7 } } ); // Karn's rule: no sample from a retransmission
+      test.execute( ExpectSRTT { 100 } );
+      test.execute( ExpectRTO { 250 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+
+      TCPSenderTestHarness test { "adaptive RTO stays within its limits", cfg };
+      test.execute( SetRTOLimits { 200, 800 } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( AckReceived { Wrap32 { isn + 1 } } );
+      test.execute( ExpectSRTT { 0 } );
+      test.execute( ExpectRTO { 200 } );
+      test.execute( Push { "a" } );
+      test.execute( ExpectMessage {}.with_data( "a" ) );
+      test.execute( Tick { 200 } );
+      test.execute( ExpectMessage {}.with_data( "a" ) );
+      test.execute( Tick { 400 } );
+      test.execute( ExpectMessage {}.with_data( "a" ) );
+      test.execute( ExpectRTO { 800 } );
+      test.execute( Tick { 800 } );
+      test.execute( ExpectMessage {}.with_data( "a" ) );
+      test.execute( ExpectRTO { 800 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      const uint16_t retx_timeout = uniform_int_distribution<uint16_t> { 10, 10000 }( rd );
+      cfg.isn = isn;
+      cfg.rt_timeout = retx_timeout;
+
+      TCPSenderTestHarness test { "RTO stays fixed without limits, but RTT is still measured", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( Tick { 5 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } } );
+      test.execute( ExpectSRTT { 5 } );
+      test.execute( ExpectRTO { retx_timeout } );
+    }
   } catch ( const exception& e ) {
     cerr << e.what() << endl;
     return 1;
@@ -140,6 +140,50 @@ int main()
       test.execute( ExpectMessage {}.with_fin( true ).with_data( "4567" ) );
       test.execute( ExpectNoSegment {} );
     }
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.send_capacity = 1 << 20;
+
+      TCPReceiverMessage syn_ack { Wrap32 { isn + 1 }, 1000 };
+      syn_ack.window_scale = 4;
+
+      TCPSenderTestHarness test { "Window scale from the SYN applies to later windows", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( Receive { syn_ack }.without_push() );
+      test.execute( Push { string( 2000, 'x' ) } );
+      test.execute( ExpectSeqnosInFlight { 1000 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 5000 >> 4 ) );
+      test.execute( ExpectSeqnosInFlight { 2000 } );
+      test.execute( Push { string( 100000, 'y' ) } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 100000 >> 4 ) );
+      test.execute( ExpectSeqnosInFlight { 100000 } );
+    }
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.isn = isn;
+      cfg.send_capacity = 1 << 20;
+
+      TCPReceiverMessage syn_ack { Wrap32 { isn + 1 }, 1000 };
+      syn_ack.window_scale = 4;
+      TCPReceiverMessage ack { Wrap32 { isn + 1 }, 5000 >> 4 };
+      ack.window_scale = 8;
+
+      TCPSenderTestHarness test { "A window scale after the SYN is ignored", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_no_flags().with_syn( true ).with_payload_size( 0 ).with_seqno( isn ) );
+      test.execute( Receive { syn_ack }.without_push() );
+      test.execute( Push { string( 8000, 'x' ) } );
+      test.execute( ExpectSeqnosInFlight { 1000 } );
+      test.execute( Receive { ack } );
+      test.execute( ExpectSeqnosInFlight { 4992 } );
+      test.execute( AckReceived { Wrap32 { isn + 1 } }.with_win( 6000 >> 4 ) );
+      test.execute( ExpectSeqnosInFlight { 6000 } );
+    }
+
   } catch ( const exception& e ) {
     cerr << e.what() << endl;
     return 1;
@@ -80,6 +80,102 @@ struct ExpectConsecutiveRetransmissions : public ExpectNumber<SenderAndOutput, u
   uint64_t value( SenderAndOutput& ss ) const override { return ss.sender.consecutive_retransmissions(); }
 };
 
+struct ExpectRTO : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "RTO_ms"; }
+  uint64_t value( SenderAndOutput& ss ) const override { return ss.sender.RTO_ms(); }
+};
+
+struct ExpectSRTT : public ExpectNumber<SenderAndOutput, std::optional<uint64_t>>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "SRTT_ms"; }
+  std::optional<uint64_t> value( SenderAndOutput& ss ) const override { return ss.sender.SRTT_ms(); }
+};
+
+struct ExpectRTTVAR : public ExpectNumber<SenderAndOutput, std::optional<uint64_t>>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "RTTVAR_ms"; }
+  std::optional<uint64_t> value( SenderAndOutput& ss ) const override { return ss.sender.RTTVAR_ms(); }
+};
+
+struct SetRTOLimits : public Action<SenderAndOutput>
+{
+  uint64_t min_, max_;
+
+  SetRTOLimits( uint64_t min, uint64_t max ) : min_( min ), max_( max ) {} // NOLINT(*-swappable-*)
+  std::string description() const override
+  {
+    return "set_RTO_limits(" + std::to_string( min_ ) + ", " + std::to_string( max_ ) + ")";
+  }
+  void execute( SenderAndOutput& ss ) const override { ss.sender.set_RTO_limits( min_, max_ ); }
+};
+
+struct SetFastRetransmit : public Action<SenderAndOutput>
+{
+  bool enabled_;
+
+  explicit SetFastRetransmit( bool enabled ) : enabled_( enabled ) {}
+  std::string description() const override { return "set_fast_retransmit(" + std::to_string( enabled_ ) + ")"; }
+  void execute( SenderAndOutput& ss ) const override { ss.sender.set_fast_retransmit( enabled_ ); }
+};
+
+struct SetMSS : public Action<SenderAndOutput>
+{
+  uint64_t mss_;
+
+  explicit SetMSS( uint64_t mss ) : mss_( mss ) {}
+  std::string description() const override { return "set_mss(" + std::to_string( mss_ ) + ")"; }
+  void execute( SenderAndOutput& ss ) const override { ss.sender.set_mss( mss_ ); }
+};
+
+struct SetOptionBytes : public Action<SenderAndOutput>
+{
+  uint64_t syn_, other_;
+
+  SetOptionBytes( uint64_t syn, uint64_t other ) : syn_( syn ), other_( other ) {}
+  std::string description() const override
+  {
+    return "set_option_bytes(" + std::to_string( syn_ ) + ", " + std::to_string( other_ ) + ")";
+  }
+  void execute( SenderAndOutput& ss ) const override { ss.sender.set_option_bytes( syn_, other_ ); }
+};
+
+struct ExpectMSS : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "mss"; }
+  uint64_t value( SenderAndOutput& ss ) const override { return ss.sender.mss(); }
+};
+
+struct SetCongestionControl : public Action<SenderAndOutput>
+{
+  CongestionAlgorithm algorithm_;
+
+  explicit SetCongestionControl( CongestionAlgorithm algorithm ) : algorithm_( algorithm ) {}
+  std::string description() const override
+  {
+    return "set_congestion_control(" + std::to_string( static_cast<int>( algorithm_ ) ) + ")";
+  }
+  void execute( SenderAndOutput& ss ) const override { ss.sender.set_congestion_control( algorithm_ ); }
+};
+
+struct ExpectCwnd : public ExpectNumber<SenderAndOutput, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "cwnd"; }
+  uint64_t value( SenderAndOutput& ss ) const override { return ss.sender.cwnd(); }
+};
+
+struct ExpectInRecovery : public ExpectBool<SenderAndOutput>
+{
+  using ExpectBool::ExpectBool;
+  std::string name() const override { return "in_recovery"; }
+  bool value( SenderAndOutput& ss ) const override { return ss.sender.in_recovery(); }
+};
+
 struct ExpectNoSegment : public Expectation<SenderAndOutput>
 {
   std::string description() const override { return "nothing to send"; }
@@ -192,7 +288,14 @@ struct Receive : public Action<SenderAndOutput>
   std::string description() const override
   {
     std::ostringstream desc;
-    desc << "receive(ack=" << to_string( msg_.ackno ) << ", win=" << msg_.window_size << ")";
+    desc << "receive(ack=" << to_string( msg_.ackno ) << ", win=" << msg_.window_size;
+    if ( msg_.mss ) {
+      desc << ", mss=" << *msg_.mss;
+    }
+    for ( const auto& block : msg_.sack ) {
+      desc << ", sack=[" << block.begin << ", " << block.end << ")";
+    }
+    desc << ")";
     if ( push_ ) {
       desc << ", then push stream to TCPSender";
     }
@@ -213,6 +316,18 @@ struct Receive : public Action<SenderAndOutput>
     }
   }
 
+  Receive& with_mss( uint16_t mss )
+  {
+    msg_.mss = mss;
+    return *this;
+  }
+
+  Receive& with_sack( Wrap32 begin, Wrap32 end )
+  {
+    msg_.sack.push_back( { begin, end } );
+    return *this;
+  }
+
   Receive& without_push()
   {
     push_ = false;
@@ -340,7 +455,7 @@ struct ExpectMessage : public Expectation<SenderAndOutput>
     if ( payload_size.has_value() and seg.payload.size() != payload_size.value() ) {
       throw ExpectationViolation( "payload_size", payload_size.value(), seg.payload.size() );
     }
-    if ( seg.payload.size() > TCPConfig::MAX_PAYLOAD_SIZE ) {
+    if ( seg.payload.size() > ss.sender.mss() ) {
       throw ExpectationViolation( "payload has length (" + std::to_string( seg.payload.size() )
                                   + ") greater than the maximum" );
     }
@@ -0,0 +1,110 @@
+#include "alloc_counter.hh"
+#include "tcp_config.hh"
+#include "tcp_sender.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+
+using namespace std;
+using namespace std::chrono;
+
+/*
+ * TCPSender throughput with a full window: the receiver acks every second segment, and each ack lets the
+ * sender push two more, so every segment is queued as outstanding, transmitted, and popped by an ack while
+ * a window's worth of others wait. Reports Gbit/s of stream sent and heap allocations per segment.
+ */
+
+void speed_test( const size_t len, const uint8_t window_scale ) // NOLINT(bugprone-easily-swappable-parameters)
+{
+  default_random_engine rd { 2024 };
+  string data( len, 0 );
+  generate( data.begin(), data.end(), [&] { return rd(); } );
+
+  const Wrap32 isn { 1234 };
+  const uint64_t window = uint64_t { UINT16_MAX } << window_scale;
+  TCPSender sender { ByteStream { window, ByteStream::Storage::Mirrored }, isn, TCPConfig::TIMEOUT_DFLT };
+
+  uint64_t sent = 0;
+  uint64_t segments = 0;
+  uint64_t checksum = 0;
+  const auto transmit = [&]( const TCPSenderMessage& msg ) {
+    sent += msg.sequence_length();
+    ++segments;
+    if ( not msg.payload.empty() ) {
+      checksum += static_cast<unsigned char>( string_view( msg.payload ).front() );
+    }
+  };
+
+  // connect: the SYN, then an ack offering the window scale (the window alongside it is never scaled)
+  sender.push( transmit );
+  sender.receive( { Wrap32::wrap( 1, isn ), UINT16_MAX, false, {}, window_scale } );
+
+  const uint64_t total = len + 2; // with SYN and FIN
+  uint64_t acked = 1;
+  uint64_t written = 0;
+
+  const auto start_allocations = heap::allocations;
+  const auto start_time = steady_clock::now();
+  while ( acked < total ) {
+    const auto room = min( sender.writer().available_capacity(), len - written );
+    if ( room ) {
+      sender.writer().push( data.substr( written, room ) );
+      written += room;
+    }
+    if ( written == len and not sender.writer().is_closed() ) {
+      sender.writer().close();
+    }
+
+    sender.push( transmit );
+    acked = min( acked + 2 * sender.mss(), sent );
+    sender.receive( { Wrap32::wrap( acked, isn ), UINT16_MAX, false, {}, {} } );
+  }
+  const auto stop_time = steady_clock::now();
+
+  sink = checksum;
+  if ( sender.sequence_numbers_in_flight() != 0 or sent != total ) {
+    throw runtime_error( "TCPSender did not send the whole stream" );
+  }
+
+  const auto test_duration = duration_cast<duration<double>>( stop_time - start_time );
+  const auto gigabits_per_second = 8 * static_cast<double>( len ) / test_duration.count() / 1e9;
+  const auto allocs_per_segment
+    = static_cast<double>( heap::allocations - start_allocations ) / static_cast<double>( segments );
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  cout << "TCPSender with window=" << setw( 8 ) << window << " reached " << fixed << setprecision( 2 )
+       << gigabits_per_second << " Gbit/s, " << allocs_per_segment << " allocations per segment.\n";
+
+  debug_output << "             TCPSender (window=" << setw( 8 ) << window << ") throughput: " << fixed
+               << setprecision( 2 ) << gigabits_per_second << " Gbit/s\n";
+
+  if ( gigabits_per_second < 0.1 ) {
+    throw runtime_error( "TCPSender did not meet minimum speed of 0.1 Gbit/s." );
+  }
+}
+
+void program_body()
+{
+  speed_test( 1 << 26, 0 );
+  speed_test( 1 << 26, 4 );
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
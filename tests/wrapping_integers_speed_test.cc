@@ -0,0 +1,105 @@
+#include "alloc_counter.hh"
+#include "wrapping_integers.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+/*
+ * Compare unwrapping bursts of seqnos one call at a time with Wrap32::unwrap() against the batch overload.
+ * Each burst is unwrapped against its own checkpoint, which advances through the sequence space (and past
+ * several wraps) the way a receiver's would. The seqnos fit in cache, and are unwrapped `rounds` times over.
+ */
+
+void speed_test( const size_t burst,      // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t num_bursts, // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t rounds )
+{
+  default_random_engine rd { 1370 };
+  const Wrap32 isn { static_cast<uint32_t>( rd() ) };
+
+  // seqnos within 64 KiB either side of each burst's checkpoint
+  vector<uint64_t> checkpoints( num_bursts );
+  vector<Wrap32> seqnos;
+  seqnos.reserve( burst * num_bursts );
+  uniform_int_distribution<uint64_t> spread { 0, 1 << 17 };
+  uint64_t checkpoint = uint64_t { 1 } << 16;
+  for ( auto& c : checkpoints ) {
+    c = checkpoint;
+    for ( size_t i = 0; i < burst; ++i ) {
+      seqnos.push_back( Wrap32::wrap( checkpoint + spread( rd ) - ( 1 << 16 ), isn ) );
+    }
+    checkpoint += 1 << 20;
+  }
+
+  vector<uint64_t> scalar( seqnos.size() );
+  vector<uint64_t> batch( seqnos.size() );
+
+  const auto scalar_start = steady_clock::now();
+  for ( size_t r = 0; r < rounds; ++r ) {
+    for ( size_t b = 0; b < num_bursts; ++b ) {
+      for ( size_t i = b * burst; i < ( b + 1 ) * burst; ++i ) {
+        scalar[i] = seqnos[i].unwrap( isn, checkpoints[b] );
+      }
+    }
+    sink = scalar[r % scalar.size()];
+  }
+  const auto scalar_stop = steady_clock::now();
+
+  const auto batch_start = steady_clock::now();
+  for ( size_t r = 0; r < rounds; ++r ) {
+    for ( size_t b = 0; b < num_bursts; ++b ) {
+      Wrap32::unwrap( span( seqnos ).subspan( b * burst, burst ),
+                      isn,
+                      checkpoints[b],
+                      span( batch ).subspan( b * burst, burst ) );
+    }
+    sink = batch[r % batch.size()];
+  }
+  const auto batch_stop = steady_clock::now();
+
+  if ( scalar != batch ) {
+    throw runtime_error( "Batch unwrap disagrees with scalar unwrap" );
+  }
+
+  const auto count = static_cast<double>( seqnos.size() * rounds );
+  const auto scalar_ns = duration_cast<duration<double, nano>>( scalar_stop - scalar_start ).count() / count;
+  const auto batch_ns = duration_cast<duration<double, nano>>( batch_stop - batch_start ).count() / count;
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  cout << "Wrap32 unwrap of " << setw( 4 ) << burst << "-seqno bursts: scalar " << fixed << setprecision( 2 )
+       << scalar_ns << " ns/seqno, batch " << batch_ns << " ns/seqno (" << scalar_ns / batch_ns
+       << "x).\n";
+
+  debug_output << "             Wrap32 unwrap (" << burst << "-seqno bursts): " << fixed << setprecision( 2 )
+               << 1e3 / scalar_ns << " M/s scalar, " << 1e3 / batch_ns << " M/s batch\n";
+}
+
+void program_body()
+{
+  for ( const size_t burst : { 8, 64, 1024 } ) {
+    speed_test( burst, ( 1 << 14 ) / burst, 1024 );
+  }
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
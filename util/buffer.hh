@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+// Buffer: an immutable string shared by reference count, so copying one (and any struct holding one) copies a
+// pointer rather than the bytes. An empty Buffer holds no allocation at all.
+class Buffer
+{
+public:
+  Buffer() = default;
+  Buffer( std::string str ) // NOLINT(*-explicit-*)
+    : buffer_( str.empty() ? nullptr : std::make_shared<std::string>( std::move( str ) ) )
+  {}
+
+  operator std::string_view() const // NOLINT(*-explicit-*)
+  {
+    return buffer_ ? std::string_view( *buffer_ ) : std::string_view {};
+  }
+  operator const std::string&() const { return buffer_ ? *buffer_ : empty_string(); } // NOLINT(*-explicit-*)
+
+  size_t size() const { return buffer_ ? buffer_->size() : 0; }
+  size_t length() const { return size(); }
+  bool empty() const { return size() == 0; }
+
+  // The string to change in place, copied first if another Buffer shares it
+  std::string& mutable_buffer()
+  {
+    if ( not buffer_ ) {
+      buffer_ = std::make_shared<std::string>();
+    } else if ( buffer_.use_count() > 1 ) {
+      buffer_ = std::make_shared<std::string>( *buffer_ );
+    }
+    return *buffer_;
+  }
+
+  // Take the string out, leaving this Buffer empty: moved if no other Buffer shares it, copied if one does
+  std::string release()
+  {
+    if ( not buffer_ ) {
+      return {};
+    }
+    std::string str = buffer_.use_count() == 1 ? std::move( *buffer_ ) : *buffer_;
+    buffer_.reset();
+    return str;
+  }
+
+private:
+  std::shared_ptr<std::string> buffer_ {};
+
+  static const std::string& empty_string()
+  {
+    static const std::string empty;
+    return empty;
+  }
+};
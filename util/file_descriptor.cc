@@ -3,6 +3,7 @@
 #include "exception.hh"
 
 #include <algorithm>
+#include <climits>
 #include <fcntl.h>
 #include <iostream>
 #include <stdexcept>
@@ -151,6 +152,43 @@ void FileDescriptor::read( vector<string>& buffers )
   }
 }
 
+size_t FileDescriptor::read( const vector<span<char>>& buffers )
+{
+  const size_t count = min( buffers.size(), static_cast<size_t>( IOV_MAX ) );
+  vector<iovec> iovecs;
+  iovecs.reserve( count );
+  size_t total_size = 0;
+  for ( size_t i = 0; i < count; ++i ) {
+    iovecs.push_back( { buffers[i].data(), buffers[i].size() } );
+    total_size += buffers[i].size();
+  }
+
+  // a zero-length read would look like EOF
+  if ( total_size == 0 ) {
+    return 0;
+  }
+
+  const ssize_t bytes_read = ::readv( fd_num(), iovecs.data(), static_cast<int>( iovecs.size() ) );
+  if ( bytes_read < 0 ) {
+    if ( internal_fd_->non_blocking_ and ( errno == EAGAIN or errno == EINPROGRESS ) ) {
+      return 0;
+    }
+    throw unix_error { "readv" };
+  }
+
+  register_read();
+
+  if ( bytes_read == 0 ) {
+    internal_fd_->eof_ = true;
+  }
+
+  if ( bytes_read > static_cast<ssize_t>( total_size ) ) {
+    throw runtime_error( "read() read more than requested" );
+  }
+
+  return bytes_read;
+}
+
 size_t FileDescriptor::write( string_view buffer )
 {
   return write( vector<string_view> { buffer } );
@@ -168,12 +206,14 @@ size_t FileDescriptor::write( const vector<std::string>& buffers )
 
 size_t FileDescriptor::write( const vector<string_view>& buffers )
 {
+  // writev() takes at most IOV_MAX buffers; anything beyond that is left for the caller's next write
+  const size_t count = min( buffers.size(), static_cast<size_t>( IOV_MAX ) );
   vector<iovec> iovecs;
-  iovecs.reserve( buffers.size() );
+  iovecs.reserve( count );
   size_t total_size = 0;
-  for ( const auto x : buffers ) {
-    iovecs.push_back( { const_cast<char*>( x.data() ), x.size() } ); // NOLINT(*-const-cast)
-    total_size += x.size();
+  for ( size_t i = 0; i < count; ++i ) {
+    iovecs.push_back( { const_cast<char*>( buffers[i].data() ), buffers[i].size() } ); // NOLINT(*-const-cast)
+    total_size += buffers[i].size();
   }
 
   const ssize_t bytes_written
@@ -191,6 +231,31 @@ size_t FileDescriptor::write( const vector<string_view>& buffers )
   return bytes_written;
 }
 
+optional<size_t> FileDescriptor::splice_to( FileDescriptor& out, size_t len )
+{
+  const bool non_blocking = internal_fd_->non_blocking_ or out.internal_fd_->non_blocking_;
+  const unsigned flags = SPLICE_F_MOVE | ( non_blocking ? SPLICE_F_NONBLOCK : 0 );
+  const ssize_t bytes_moved = ::splice( fd_num(), nullptr, out.fd_num(), nullptr, len, flags );
+  if ( bytes_moved < 0 ) {
+    if ( errno == EINVAL or errno == ESPIPE ) {
+      return nullopt; // neither end is a pipe, or one end doesn't support splicing
+    }
+    if ( non_blocking and errno == EAGAIN ) {
+      return 0;
+    }
+    throw unix_error { "splice" };
+  }
+
+  register_read();
+  out.register_write();
+
+  if ( bytes_moved == 0 and len != 0 ) {
+    internal_fd_->eof_ = true;
+  }
+
+  return bytes_moved;
+}
+
 void FileDescriptor::set_blocking( bool blocking )
 {
   int flags = CheckSystemCall( "fcntl", fcntl( fd_num(), F_GETFL ) ); // NOLINT(*-vararg)
@@ -3,6 +3,8 @@
 #include <cstddef>
 #include <limits>
 #include <memory>
+#include <optional>
+#include <span>
 #include <vector>
 
 // A reference-counted handle to a file descriptor
@@ -64,6 +66,8 @@ public:
   // Read into `buffer`
   void read( std::string& buffer );
   void read( std::vector<std::string>& buffers );
+  // Read (with readv) into caller-owned buffers, filled in order; returns number of bytes read
+  size_t read( const std::vector<std::span<char>>& buffers );
 
   // Attempt to write a buffer
   // returns number of bytes written
@@ -71,6 +75,12 @@ public:
   size_t write( const std::vector<std::string_view>& buffers );
   size_t write( const std::vector<std::string>& buffers );
 
+  // Move up to `len` bytes from this fd to `out` inside the kernel with [splice(2)](\ref man2::splice),
+  // without copying them through user space. One of the two fds must be a pipe. Returns the number of
+  // bytes moved, or std::nullopt if the kernel can't splice between these fds (the caller should fall
+  // back to read() and write()).
+  std::optional<size_t> splice_to( FileDescriptor& out, size_t len );
+
   // Close the underlying file descriptor
   void close() { internal_fd_->close(); }
 
@@ -1,10 +1,13 @@
 #pragma once
 
 #include "address.hh"
+#include "congestion_control.hh"
+#include "pending_budget.hh"
 #include "wrapping_integers.hh"
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <optional>
 
 //! Config for TCP sender and receiver
@@ -12,14 +15,30 @@ class TCPConfig
 {
 public:
   static constexpr size_t DEFAULT_CAPACITY = 64000; //!< Default capacity
-  static constexpr size_t MAX_PAYLOAD_SIZE = 1000;  //!< Conservative max payload size for real Internet
+  static constexpr size_t MAX_PAYLOAD_SIZE = 1000;  //!< Conservative default MSS for real Internet
   static constexpr uint16_t TIMEOUT_DFLT = 1000;    //!< Default re-transmit timeout is 1 second
   static constexpr unsigned MAX_RETX_ATTEMPTS = 8;  //!< Maximum re-transmit attempts before giving up
 
   uint16_t rt_timeout = TIMEOUT_DFLT;      //!< Initial value of the retransmission timeout, in milliseconds
+  uint64_t rto_min_ms = 200;               //!< Least the RTO may adapt to from measured round-trip times
+  uint64_t rto_max_ms = 60000;             //!< Most the RTO may adapt or back off to
   size_t recv_capacity = DEFAULT_CAPACITY; //!< Receive capacity, in bytes
   size_t send_capacity = DEFAULT_CAPACITY; //!< Sender capacity, in bytes
   Wrap32 isn { 137 };                      //!< Default initial sequence number
+  bool stream_stats = false;               //!< Collect ByteStream::Stats on the inbound and outbound streams
+  uint64_t recv_max_pending = UINT64_MAX;  //!< Most memory the receiver's out-of-order bytes may use
+  bool window_scaling = true;              //!< Offer window scaling (RFC 7323) on SYN
+  uint16_t mss = MAX_PAYLOAD_SIZE;         //!< Largest payload per segment, advertised on SYN
+  uint16_t delayed_ack_ms = 40;            //!< Longest an ACK of in-order data may wait (0 = ack every segment)
+  bool fast_retransmit = true;             //!< Recover losses from duplicate ACKs and SACK, not just the RTO
+  bool sack = true;                        //!< Offer SACK (RFC 2018) on SYN; blocks are sent only if both offer it
+
+  //! Congestion control for the sender, and whether to pace its segments over the round trip
+  CongestionAlgorithm congestion_control = CongestionAlgorithm::NewReno;
+  bool pacing = false;
+
+  //! Limit on the memory held by the out-of-order bytes of every receiver given the same budget
+  std::shared_ptr<PendingBudget> recv_pending_budget {};
 };
 
 //! Config for classes derived from FdAdapter
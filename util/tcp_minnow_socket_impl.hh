@@ -105,10 +105,8 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
     _thread_data,
     Direction::In,
     [&] {
-      std::string data;
-      data.resize( _tcp->outbound_writer().available_capacity() );
-      _thread_data.read( data );
-      _tcp->outbound_writer().push( move( data ) );
+      Writer& outbound = _tcp->outbound_writer();
+      outbound.commit( _thread_data.read( outbound.reserve( outbound.available_capacity() ) ) );
 
       if ( _thread_data.eof() ) {
         _tcp->outbound_writer().close();
@@ -143,13 +141,13 @@ void TCPMinnowSocket<AdaptT>::_initialize_TCP( const TCPConfig& config )
     Direction::Out,
     [&] {
       Reader& inbound = _tcp->inbound_reader();
-      // Write from the inbound_stream into
-      // the pipe, handling the possibility of a partial
+      // Write everything buffered in the inbound_stream into
+      // the pipe with one writev, handling the possibility of a partial
       // write (i.e., only pop what was actually written).
       if ( inbound.bytes_buffered() ) {
-        const std::string_view buffer = inbound.peek();
-        const auto bytes_written = _thread_data.write( buffer );
+        const auto bytes_written = _thread_data.write( inbound.peek_all() );
         inbound.pop( bytes_written );
+        _tcp->inbound_drained();
       }
 
       if ( inbound.is_finished() or inbound.has_error() ) {
@@ -286,6 +284,11 @@ void TCPMinnowSocket<AdaptT>::_tcp_main()
       std::cerr << "DEBUG: minnow TCP connection finished "
                 << ( _tcp->inbound_reader().has_error() ? "uncleanly.\n" : "cleanly.\n" );
     }
+    if ( _tcp->sender().reader().stats_enabled() ) {
+      std::cerr << "DEBUG: minnow outbound stream stats: " << _tcp->sender().reader().stats() << "\n";
+      std::cerr << "DEBUG: minnow inbound stream stats: " << _tcp->receiver().reader().stats() << "\n";
+      std::cerr << "DEBUG: minnow reassembler stats: " << _tcp->receiver().reassembler().stats() << "\n";
+    }
     _tcp.reset();
   } catch ( const std::exception& e ) {
     std::cerr << "Exception in TCPConnection runner thread: " << e.what() << "\n";
@@ -18,20 +18,55 @@ class TCPPeer
   }
 
 public:
-  explicit TCPPeer( const TCPConfig& cfg ) : cfg_( cfg ) {}
+  explicit TCPPeer( const TCPConfig& cfg ) : cfg_( cfg )
+  {
+    receiver_.set_reassembler_limits( { cfg_.recv_max_pending, cfg_.recv_pending_budget } );
+    sender_.set_RTO_limits( cfg_.rto_min_ms, cfg_.rto_max_ms );
+    receiver_.advertise_mss( cfg_.mss );
+    sender_.set_mss( cfg_.mss );
+    sender_.set_congestion_control( cfg_.congestion_control, cfg_.pacing );
+    sender_.set_fast_retransmit( cfg_.fast_retransmit );
+    if ( cfg_.window_scaling ) {
+      receiver_.offer_window_scale();
+    }
+    if ( cfg_.sack ) {
+      receiver_.offer_sack();
+    }
+    if ( cfg_.stream_stats ) {
+      sender_.writer().enable_stats();
+      receiver_.reader().enable_stats();
+    }
+    // the peer's SYN can only take offers away, so these bytes are enough for any SYN we send
+    syn_option_bytes_ = TCPSegment::options_length( receiver_.send( true ), true );
+  }
 
   Writer& outbound_writer() { return sender_.writer(); }
   Reader& inbound_reader() { return receiver_.reader(); }
+  void inbound_drained()
+  {
+    receiver_.flush();
+    sack_changed_ = true;
+  }
 
   /* Type of the `transmit` function that the push and tick methods can use to send messages */
   using TransmitFunction = std::function<void( TCPMessage )>;
 
   /* Passthrough methods */
-  void push( const TransmitFunction& transmit ) { sender_.push( make_send( transmit ) ); }
+  void push( const TransmitFunction& transmit )
+  {
+    make_room_for_options();
+    sender_.push( make_send( transmit ) );
+  }
   void tick( uint64_t t, const TransmitFunction& transmit )
   {
     cumulative_time_ += t;
+    make_room_for_options();
     sender_.tick( t, make_send( transmit ) );
+
+    // Send a delayed ACK once its timer runs out (unless a retransmission above already carried it).
+    if ( ack_delayed_since_ and cumulative_time_ >= *ack_delayed_since_ + cfg_.delayed_ack_ms ) {
+      send( sender_.make_empty_message(), transmit );
+    }
   }
   bool has_ackno() const { return receiver_.send().ackno.has_value(); }
 
@@ -56,24 +91,52 @@ public:
     // Record time in case this peer has to linger after streams finish.
     time_of_last_receipt_ = cumulative_time_;
 
-    // If SenderMessage occupies a sequence number, make sure to reply.
-    need_send_ |= ( msg.sender.sequence_length() > 0 );
-
     // If SenderMessage is a "keep-alive" (with intentionally invalid seqno), make sure to reply.
     // (N.B. orthodox TCP rules require a reply on any unacceptable segment.)
     const auto our_ackno = receiver_.send().ackno;
     need_send_ |= ( our_ackno.has_value() and msg.sender.seqno + 1 == our_ackno.value() );
 
+    // Data that arrives in order, with no gap waiting behind it, may be acked later (see below).
+    const auto sequence_length = msg.sender.sequence_length();
+    const bool in_order = our_ackno.has_value() and msg.sender.seqno == our_ackno.value() and not msg.sender.SYN
+                          and not msg.sender.FIN and receiver_.reassembler().bytes_pending() == 0;
+
     // Did the inbound stream finish before the outbound stream? If so, no need to linger after streams finish.
     if ( receiver_.writer().is_closed() and not sender_.reader().is_finished() ) {
       linger_after_streams_finish_ = false;
     }
 
+    // Window scaling and SACK are in effect only if both SYNs offered them (RFC 7323, RFC 2018).
+    if ( msg.sender.SYN ) {
+      if ( not cfg_.window_scaling ) {
+        msg.receiver.window_scale.reset();
+      }
+      receiver_.set_peer_window_scale( msg.receiver.window_scale.has_value() );
+      receiver_.set_peer_sack( cfg_.sack and msg.receiver.sack_permitted );
+    }
+
     // Give incoming TCPSenderMessage to receiver.
     receiver_.receive( std::move( msg.sender ) );
+    sack_changed_ = true;
+
+    // If SenderMessage occupies a sequence number, make sure to reply: at once for a SYN, a FIN, data out of
+    // order or not all accepted, but only for every second full-sized segment of in-order data, or once the
+    // delayed-ACK timer runs out (RFC 1122 4.2.3.2, RFC 5681 4.2).
+    if ( sequence_length > 0 ) {
+      const bool accepted = in_order and receiver_.send().ackno == our_ackno.value() + sequence_length;
+      if ( cfg_.delayed_ack_ms == 0 or not accepted ) {
+        need_send_ = true;
+      } else {
+        unacked_bytes_ += sequence_length;
+        need_send_ |= unacked_bytes_ >= 2 * sender_.mss();
+        if ( not ack_delayed_since_ ) {
+          ack_delayed_since_ = cumulative_time_;
+        }
+      }
+    }
 
     // Give incoming TCPReceiverMessage to sender.
-    sender_.receive( msg.receiver );
+    sender_.receive( msg.receiver, sequence_length > 0 );
 
     // Send reply if needed.
     push( transmit );
@@ -88,16 +151,40 @@ public:
 
 private:
   TCPConfig cfg_;
-  TCPSender sender_ { ByteStream { cfg_.send_capacity }, cfg_.isn, cfg_.rt_timeout };
-  TCPReceiver receiver_ { Reassembler { ByteStream { cfg_.recv_capacity } } };
+  TCPSender sender_ { ByteStream { cfg_.send_capacity, ByteStream::Storage::Mirrored },
+                      cfg_.isn,
+                      cfg_.rt_timeout };
+  TCPReceiver receiver_ { Reassembler { ByteStream { cfg_.recv_capacity, ByteStream::Storage::Chunked } } };
 
   bool need_send_ {};
+  uint64_t syn_option_bytes_ {};
+  bool sack_changed_ { true }; // since the sender last heard how many option bytes to leave room for
+  uint64_t unacked_bytes_ {};                   // in-order bytes received since our last ACK
+  std::optional<uint64_t> ack_delayed_since_ {}; // when the oldest of them arrived
 
   void send( const TCPSenderMessage& sender_message, const TransmitFunction& transmit )
   {
-    TCPMessage msg { sender_message, receiver_.send() };
+    TCPMessage msg { sender_message, receiver_.send( sender_message.SYN ) };
+    // a segment cut before these SACK blocks were known sends only as many as fit within the MSS
+    while ( not msg.receiver.sack.empty()
+            and msg.sender.payload.size() + TCPSegment::options_length( msg.receiver, msg.sender.SYN )
+                  > sender_.mss() ) {
+      msg.receiver.sack.pop_back();
+    }
     transmit( std::move( msg ) );
     need_send_ = false;
+    unacked_bytes_ = 0;
+    ack_delayed_since_.reset();
+  }
+
+  // Tell the sender how many bytes of options our next segments will carry, to keep them within the MSS. Past
+  // the SYN, that only changes with the SACK blocks, so only after the receiver takes or releases bytes.
+  void make_room_for_options()
+  {
+    if ( sack_changed_ ) {
+      sender_.set_option_bytes( syn_option_bytes_, TCPSegment::options_length( receiver_.send(), false ) );
+      sack_changed_ = false;
+    }
   }
 
   bool linger_after_streams_finish_ { true }; // one peer may need to linger to make sure all closure conditions met
@@ -2,26 +2,57 @@
 
 #include "wrapping_integers.hh"
 
+#include <cstddef>
+#include <cstdint>
 #include <optional>
+#include <vector>
 
 /*
  * The TCPReceiverMessage structure contains the information sent from a TCP receiver to its sender.
  *
- * It contains three fields:
+ * It contains seven fields:
  *
  * 1) The acknowledgment number (ackno): the *next* sequence number needed by the TCP Receiver.
  *    This is an optional field that is empty if the TCPReceiver hasn't yet received the Initial Sequence Number.
  *
  * 2) The window size. This is the number of sequence numbers that the TCP receiver is interested
  *    to receive, starting from the ackno if present. The maximum value is 65,535 (UINT16_MAX from
- *    the <cstdint> header).
+ *    the <cstdint> header), in units of 2^shift bytes once window scaling is in effect (see 5).
  *
  * 3) The RST (reset) flag. If set, the stream has suffered an error and the connection should be aborted.
+ *
+ * 4) The SACK blocks: [begin, end) ranges of sequence numbers received beyond the ackno, the block holding
+ *    the most recently received segment first (RFC 2018). At most MAX_SACK_BLOCKS are sent (fewer if the
+ *    other options leave no room), and only once both SYNs have offered SACK (see 7).
+ *
+ * 5) The window scale (RFC 7323), offered only alongside a SYN: the shift the receiver will apply to every
+ *    later window size. Scaling is in effect only if both SYNs offered it, and never applies to the window
+ *    size of a message carrying the offer.
+ *
+ * 6) The maximum segment size (MSS), advertised only alongside a SYN: the largest payload the receiver wants
+ *    in one segment. The peer's sender uses the smaller of this and its own MSS, less the bytes of TCP options
+ *    each segment carries (RFC 6691).
+ *
+ * 7) SACK-permitted (RFC 2018), offered only alongside a SYN: the receiver can send SACK blocks, and its
+ *    sender understands them.
  */
 
 struct TCPReceiverMessage
 {
+  struct SACKBlock
+  {
+    Wrap32 begin;
+    Wrap32 end;
+  };
+
+  static constexpr size_t MAX_SACK_BLOCKS = 4;   // as many as fit in the 40 bytes of TCP options
+  static constexpr uint8_t MAX_WINDOW_SCALE = 14; // larger shifts would let the window pass half the seqno space
+
   std::optional<Wrap32> ackno {};
   uint16_t window_size {};
   bool RST {};
+  std::vector<SACKBlock> sack {};
+  std::optional<uint8_t> window_scale {};
+  std::optional<uint16_t> mss {};
+  bool sack_permitted {};
 };
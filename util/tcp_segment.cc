@@ -2,12 +2,119 @@
 #include "checksum.hh"
 #include "wrapping_integers.hh"
 
+#include <algorithm>
 #include <cstddef>
+#include <string>
+#include <utility>
 
-static constexpr uint32_t TCPHeaderMinLen = 5; // 32-bit words
+static constexpr uint32_t TCPHeaderMinLen = 5;  // 32-bit words
+static constexpr uint32_t TCPHeaderMaxLen = 15; // the most the 4-bit data offset can say
+
+// TCP option kinds
+static constexpr uint8_t TCPOptionEnd = 0;
+static constexpr uint8_t TCPOptionNop = 1;
+static constexpr uint8_t TCPOptionMSS = 2;
+static constexpr uint8_t TCPOptionWindowScale = 3;
+static constexpr uint8_t TCPOptionSACKPermitted = 4;
+static constexpr uint8_t TCPOptionSACK = 5;
 
 using namespace std;
 
+namespace {
+
+// Read `len` bytes of options, keeping the ones we understand and skipping the rest
+void parse_options( Parser& parser, size_t len, TCPMessage& message )
+{
+  message.receiver.sack.clear();
+  message.receiver.window_scale.reset();
+  message.receiver.mss.reset();
+  message.receiver.sack_permitted = false;
+
+  uint8_t kind {};
+  uint8_t size {};
+  uint32_t begin {};
+  uint32_t end {};
+  while ( len > 0 and not parser.has_error() ) {
+    parser.integer( kind );
+    --len;
+    if ( kind == TCPOptionEnd ) {
+      break;
+    }
+    if ( kind == TCPOptionNop ) {
+      continue;
+    }
+
+    if ( len == 0 ) {
+      parser.set_error();
+      return;
+    }
+    parser.integer( size );
+    --len;
+    if ( size < 2 or size - 2U > len ) {
+      parser.set_error();
+      return;
+    }
+    size_t body = size - 2U;
+    len -= body;
+
+    // the MSS, window scale and SACK-permitted mean something only on a SYN (RFC 9293 3.7.1, RFC 7323 2.2,
+    // RFC 2018 2), so elsewhere they are skipped like unknown options
+    const bool syn_only = kind == TCPOptionMSS or kind == TCPOptionWindowScale or kind == TCPOptionSACKPermitted;
+    if ( syn_only and not message.sender.SYN ) {
+      parser.remove_prefix( body );
+    } else if ( kind == TCPOptionMSS and body == 2 ) {
+      message.receiver.mss.emplace();
+      parser.integer( *message.receiver.mss );
+    } else if ( kind == TCPOptionWindowScale and body == 1 ) {
+      message.receiver.window_scale.emplace();
+      parser.integer( *message.receiver.window_scale );
+    } else if ( kind == TCPOptionSACKPermitted and body == 0 ) {
+      message.receiver.sack_permitted = true;
+    } else if ( kind == TCPOptionSACK and body % 8 == 0 ) {
+      for ( ; body > 0; body -= 8 ) {
+        parser.integer( begin );
+        parser.integer( end );
+        message.receiver.sack.push_back( { Wrap32 { begin }, Wrap32 { end } } );
+      }
+    } else {
+      parser.remove_prefix( body );
+    }
+  }
+
+  // anything after the end-of-options marker is padding
+  parser.remove_prefix( len );
+}
+
+// The options serialize() writes for a receiver message, alongside a SYN or not
+struct Options
+{
+  bool mss;            // 4 bytes
+  bool window_scale;   // 3 bytes, after a NOP
+  bool sack_permitted; // 2 bytes, after two NOPs
+  size_t sack_blocks;  // 8 bytes each, after two NOPs and a 2-byte header
+
+  Options( const TCPReceiverMessage& receiver, bool syn )
+    : mss( syn and receiver.mss.has_value() )
+    , window_scale( syn and receiver.window_scale.has_value() )
+    , sack_permitted( syn and receiver.sack_permitted )
+    , sack_blocks( 0 )
+  {
+    // the MSS, window scale and SACK-permitted only go with a SYN; SACK blocks get whatever room they leave
+    const size_t free_words = TCPHeaderMaxLen - TCPHeaderMinLen - words();
+    if ( receiver.ackno.has_value() and free_words >= 3 ) {
+      sack_blocks = min( { receiver.sack.size(), TCPReceiverMessage::MAX_SACK_BLOCKS, ( free_words - 1 ) / 2 } );
+    }
+  }
+
+  size_t words() const
+  {
+    return ( mss ? 1 : 0 ) + ( window_scale ? 1 : 0 ) + ( sack_permitted ? 1 : 0 )
+           + ( sack_blocks ? 1 + 2 * sack_blocks : 0 );
+  }
+};
+
+} // namespace
+
 void TCPSegment::parse( Parser& parser, uint32_t datagram_layer_pseudo_checksum )
 {
   /* verify checksum */
@@ -47,13 +154,16 @@ void TCPSegment::parse( Parser& parser, uint32_t datagram_layer_pseudo_checksum
   parser.integer( udinfo.cksum );
   parser.integer( raw16 ); // urgent pointer
 
-  // skip any options or anything extra in the header
+  // read the options (and skip anything extra in the header)
   if ( data_offset < TCPHeaderMinLen ) {
     parser.set_error();
+    return;
   }
-  parser.remove_prefix( data_offset * 4 - TCPHeaderMinLen * 4 );
+  parse_options( parser, data_offset * 4 - TCPHeaderMinLen * 4, message );
 
-  parser.all_remaining( message.sender.payload );
+  string payload;
+  parser.all_remaining( payload );
+  message.sender.payload = move( payload );
 }
 
 class Wrap32Serializable : public Wrap32
@@ -68,7 +178,8 @@ void TCPSegment::serialize( Serializer& serializer ) const
   serializer.integer( udinfo.dst_port );
   serializer.integer( Wrap32Serializable { message.sender.seqno }.raw_value() );
   serializer.integer( Wrap32Serializable { message.receiver.ackno.value_or( Wrap32 { 0 } ) }.raw_value() );
-  serializer.integer( uint8_t { TCPHeaderMinLen << 4 } ); // data offset
+  const Options options { message.receiver, message.sender.SYN };
+  serializer.integer( static_cast<uint8_t>( ( TCPHeaderMinLen + options.words() ) << 4 ) ); // data offset
   const bool reset = message.sender.RST or message.receiver.RST;
   const uint8_t flags = ( message.receiver.ackno.has_value() ? 0b0001'0000U : 0 ) | ( reset ? 0b0000'0100U : 0 )
                         | ( message.sender.SYN ? 0b0000'0010U : 0 ) | ( message.sender.FIN ? 0b0000'0001U : 0 );
@@ -76,9 +187,42 @@ void TCPSegment::serialize( Serializer& serializer ) const
   serializer.integer( message.receiver.window_size );
   serializer.integer( udinfo.cksum );
   serializer.integer( uint16_t { 0 } ); // urgent pointer
+  if ( options.mss ) {
+    serializer.integer( TCPOptionMSS );
+    serializer.integer( uint8_t { 4 } );
+    serializer.integer( *message.receiver.mss );
+  }
+  if ( options.window_scale ) {
+    serializer.integer( TCPOptionNop );
+    serializer.integer( TCPOptionWindowScale );
+    serializer.integer( uint8_t { 3 } );
+    serializer.integer( *message.receiver.window_scale );
+  }
+  if ( options.sack_permitted ) {
+    serializer.integer( TCPOptionNop );
+    serializer.integer( TCPOptionNop );
+    serializer.integer( TCPOptionSACKPermitted );
+    serializer.integer( uint8_t { 2 } );
+  }
+  if ( options.sack_blocks ) {
+    const auto& sack = message.receiver.sack;
+    serializer.integer( TCPOptionNop );
+    serializer.integer( TCPOptionNop );
+    serializer.integer( TCPOptionSACK );
+    serializer.integer( static_cast<uint8_t>( 2 + 8 * options.sack_blocks ) );
+    for ( size_t i = 0; i < options.sack_blocks; ++i ) {
+      serializer.integer( Wrap32Serializable { sack[i].begin }.raw_value() );
+      serializer.integer( Wrap32Serializable { sack[i].end }.raw_value() );
+    }
+  }
   serializer.buffer( message.sender.payload );
 }
 
+size_t TCPSegment::options_length( const TCPReceiverMessage& receiver, bool syn )
+{
+  return 4 * Options { receiver, syn }.words();
+}
+
 void TCPSegment::compute_checksum( uint32_t datagram_layer_pseudo_checksum )
 {
   udinfo.cksum = 0;
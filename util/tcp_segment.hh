@@ -19,5 +19,8 @@ struct TCPSegment
   void parse( Parser& parser, uint32_t datagram_layer_pseudo_checksum );
   void serialize( Serializer& serializer ) const;
 
+  // Bytes of TCP options serialize() writes for a receiver message, alongside a SYN or not
+  static size_t options_length( const TCPReceiverMessage& receiver, bool syn );
+
   void compute_checksum( uint32_t datagram_layer_pseudo_checksum );
 };
@@ -1,8 +1,9 @@
 #pragma once
 
+#include "buffer.hh"
 #include "wrapping_integers.hh"
 
-#include <string>
+#include <cstddef>
 
 /*
  * The TCPSenderMessage structure contains the information sent from a TCP sender to its receiver.
@@ -15,7 +16,7 @@
  * 2) The SYN flag. If set, this segment is the beginning of the byte stream, and the seqno field
  *    contains the Initial Sequence Number (ISN) -- the zero point.
  *
- * 3) The payload: a substring (possibly empty) of the byte stream.
+ * 3) The payload: a substring (possibly empty) of the byte stream. Copies of the message share it.
  *
  * 4) The FIN flag. If set, the payload represents the ending of the byte stream.
  *
@@ -27,7 +28,7 @@ struct TCPSenderMessage
   Wrap32 seqno { 0 };
 
   bool SYN {};
-  std::string payload {};
+  Buffer payload {};
   bool FIN {};
 
   bool RST {};